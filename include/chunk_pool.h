@@ -0,0 +1,185 @@
+/*!
+ * @defgroup ChunkPool
+ *
+ * @brief A module for recycling fixed-size I/O buffers.
+ *
+ * The pool carves equally sized chunks out of large anonymous `mmap` regions
+ * and keeps the released ones on a free list threaded through the chunks
+ * themselves. Taking and returning a chunk never reaches the system
+ * allocator; a new region is mapped only when the free list runs dry.
+ *
+ * Regions may be backed by huge pages. With `CHUNK_POOL_HUGETLB` the pool
+ * first asks for `MAP_HUGETLB` pages and, if none are reserved, falls back to
+ * regular pages advised with `MADV_HUGEPAGE` so transparent huge pages can
+ * back them. Either way a region is covered by a few TLB entries instead of
+ * one per page.
+ *
+ * The regions never move once mapped, so they can be handed to the kernel as
+ * io_uring fixed buffers: `chunk_pool_reserve` maps them up front,
+ * `chunk_pool_regions` lists them for `io_uring_register_buffers` and
+ * `chunk_pool_region_of` tells which registered buffer a chunk belongs to.
+ *
+ * Each pool has its own mutex: pools owned by different io_uring rings never
+ * contend with each other.
+ *
+ * ### General Diagram of the Chunk Pool:
+ *
+ * ```
+ * region 0: [chunk|chunk|chunk|chunk|...]   (mmap, chunk_sz * per_region)
+ * region 1: [chunk|chunk|chunk|chunk|...]
+ *              |           ^     |
+ * free -------+            |     |
+ *   chunk.next ------------+     |
+ *   ...                          v
+ * ```
+ *
+ * ### Example Usage:
+ *
+ * ```c
+ * #include "chunk_pool.h"
+ *
+ * int main() {
+ *     struct chunk_pool *pool = chunk_pool_create(8192, 256, 0);
+ *
+ *     void *buf = chunk_pool_get(pool);
+ *     chunk_pool_put(pool, buf);
+ *
+ *     chunk_pool_destroy(pool);
+ *     return 0;
+ * }
+ * ```
+ *
+ * @author Israel
+ * @date 2024
+ *
+ * @{
+ */
+#ifndef CHUNK_POOL_H
+#define CHUNK_POOL_H
+
+#include <stdint.h>  // for uint64_t, uint32_t, int64_t
+#include <sys/uio.h> // for iovec
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ * @brief Flag asking `chunk_pool_create` to back its regions with huge pages.
+ */
+#define CHUNK_POOL_HUGETLB 1U
+
+  /*!
+   * @struct chunk_pool
+   * @brief Represents a pool of fixed-size buffers.
+   */
+  struct chunk_pool;
+
+  /*!
+   * @brief Counters describing the usage of a chunk pool.
+   */
+  struct chunk_pool_stats
+  {
+    /*! Number of chunks currently handed out. */
+    uint64_t in_use;
+    /*! Highest value `in_use` has reached. */
+    uint64_t high_water;
+    /*! Number of chunks carved from the mapped regions. */
+    uint64_t capacity;
+    /*! Number of mapped regions. */
+    uint64_t regions;
+    /*! Number of regions backed by huge pages (`MAP_HUGETLB`). */
+    uint64_t huge_regions;
+  };
+
+  /*!
+   * @brief Creates a new chunk pool.
+   *
+   * No memory is mapped until the first chunk is requested.
+   *
+   * @param chunk_sz Size of every chunk. Rounded up to a multiple of 64.
+   * @param per_region Number of chunks carved from every region.
+   * @param flags `CHUNK_POOL_HUGETLB` or 0.
+   * @return A pointer to the created pool, or `NULL` if creation fails.
+   */
+  [[nodiscard]]
+  struct chunk_pool *chunk_pool_create (uint64_t chunk_sz, uint32_t per_region,
+                                        uint32_t flags);
+
+  /*!
+   * @brief Takes a chunk from the pool, mapping a new region if needed.
+   *
+   * @param pool Pointer to the pool.
+   * @return A pointer to the chunk, or `NULL` if no region could be mapped.
+   */
+  [[nodiscard]]
+  void *chunk_pool_get (struct chunk_pool *pool);
+
+  /*!
+   * @brief Maps regions until the pool holds at least `regions` of them.
+   *
+   * @param pool Pointer to the pool.
+   * @param regions Number of regions the pool must have mapped.
+   * @return `SUCCESS_CODE` on success, `ERROR_CODE` if a region could not be
+   * mapped.
+   */
+  [[nodiscard]]
+  int chunk_pool_reserve (struct chunk_pool *pool, uint32_t regions);
+
+  /*!
+   * @brief Returns a chunk to the pool.
+   *
+   * @param pool Pointer to the pool the chunk was taken from.
+   * @param chunk Chunk returned by `chunk_pool_get`. May be `NULL`.
+   */
+  void chunk_pool_put (struct chunk_pool *pool, void *chunk);
+
+  /*!
+   * @brief Lists the mapped regions, oldest first.
+   *
+   * @param pool Pointer to the pool.
+   * @param iovs Destination of the base and size of every region.
+   * @param max Capacity of `iovs`.
+   * @return Number of entries written to `iovs`.
+   */
+  uint32_t chunk_pool_regions (struct chunk_pool *pool, struct iovec *iovs,
+                               uint32_t max);
+
+  /*!
+   * @brief Finds the region a chunk was carved from.
+   *
+   * @param pool Pointer to the pool.
+   * @param chunk Chunk returned by `chunk_pool_get`.
+   * @return Index of the region, as listed by `chunk_pool_regions`, or -1 if
+   * the chunk does not belong to the pool.
+   */
+  int64_t chunk_pool_region_of (struct chunk_pool *pool, const void *chunk);
+
+  /*!
+   * @brief Reads the counters of a pool.
+   *
+   * @param pool Pointer to the pool.
+   * @param stats Destination of the counters.
+   */
+  void chunk_pool_get_stats (struct chunk_pool *pool,
+                             struct chunk_pool_stats *stats);
+
+  /*!
+   * @brief Unmaps every region and frees the pool.
+   *
+   * Chunks still in use become invalid.
+   *
+   * @param pool Pointer to the pool to destroy.
+   */
+  void chunk_pool_destroy (struct chunk_pool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !CHUNK_POOL_H
+
+/*!
+ * @}
+ */
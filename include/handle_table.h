@@ -0,0 +1,166 @@
+/*!
+ * @defgroup HandleTable
+ *
+ * @brief A module for tracking live objects through index-addressed handles.
+ *
+ * This module keeps an array of slots, a free list threaded through the
+ * unused slots and a generation counter per slot. Inserting an object pops a
+ * slot from the free list and deleting it pushes the slot back, so both
+ * operations take constant time no matter how many objects are alive. Each
+ * table has its own mutex: tables owned by different io_uring rings never
+ * contend with each other.
+ *
+ * A handle packs the slot index in its lower 32 bits and the slot generation
+ * in its upper 32 bits. The generation is bumped every time a slot is
+ * released, so a stale handle never reaches an object that reused the slot.
+ *
+ * ### General Diagram of the Handle Table:
+ *
+ * ```
+ * slots:  [0: ptr=A gen=1] [1: free gen=3] [2: ptr=B gen=2] [3: free gen=1]
+ *                                |                               ^
+ * free_head = 1 -----------------+-------------------------------+
+ *
+ * handle(A) = (1 << 32) | 0
+ * handle(B) = (2 << 32) | 2
+ * ```
+ *
+ * ### Example Usage:
+ *
+ * ```c
+ * #include "handle_table.h"
+ * #include <stdlib.h>
+ *
+ * int main() {
+ *     struct handle_table *table = handle_table_create(16, free);
+ *
+ *     uint64_t h = handle_table_insert(table, malloc(42));
+ *     if (h == HANDLE_INVALID) {
+ *         return 1;
+ *     }
+ *
+ *     handle_table_delete(table, h);
+ *
+ *     handle_table_destroy(table);
+ *     return 0;
+ * }
+ * ```
+ *
+ * @author Israel
+ * @date 2024
+ *
+ * @{
+ */
+#ifndef HANDLE_TABLE_H
+#define HANDLE_TABLE_H
+
+#include <stdint.h> // for uint64_t, uint32_t
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ * @brief Value returned by `handle_table_insert` when no handle could be
+ * assigned. Generations start at 1, so no valid handle is ever 0.
+ */
+#define HANDLE_INVALID 0UL
+
+  /*!
+   * @struct handle_table
+   * @brief Represents a table of live objects addressed by handle.
+   *
+   * The table owns the objects stored in it: they are handed to the release
+   * callback when deleted or when the table is destroyed.
+   */
+  struct handle_table;
+
+  /*!
+   * @brief Creates a new handle table.
+   *
+   * @param capacity Initial number of slots. The table doubles its capacity
+   * whenever it runs out of free slots.
+   * @param release Callback used to free the stored objects. May be `NULL`.
+   * @return A pointer to the created table, or `NULL` if creation fails.
+   */
+  [[nodiscard]]
+  struct handle_table *handle_table_create (uint32_t capacity,
+                                            void (*release) (void *));
+
+  /*!
+   * @brief Stores an object in the table.
+   *
+   * @param table Pointer to the table.
+   * @param ptr Pointer to the object to store.
+   * @return The handle that identifies the object, or `HANDLE_INVALID` if the
+   * table could not grow.
+   *
+   * ### Insert Operation Diagram:
+   * ```
+   * Before:
+   * free_head = 1 -> [1: free] -> [3: free] -> END
+   *
+   * After inserting C:
+   * [1: ptr=C gen=3]
+   * free_head = 3 -> [3: free] -> END
+   * ```
+   */
+  [[nodiscard]]
+  uint64_t handle_table_insert (struct handle_table *table, void *ptr);
+
+  /*!
+   * @brief Looks up the object identified by a handle.
+   *
+   * @param table Pointer to the table.
+   * @param handle Handle returned by `handle_table_insert`.
+   * @return The stored object, or `NULL` if the handle is stale or invalid.
+   */
+  [[nodiscard]]
+  void *handle_table_get (struct handle_table *table, const uint64_t handle);
+
+  /*!
+   * @brief Removes an object from the table and releases it.
+   *
+   * @param table Pointer to the table.
+   * @param handle Handle returned by `handle_table_insert`.
+   * @return `SUCCESS_CODE` on success, or `ERROR_CODE` if the handle is stale
+   * or invalid.
+   *
+   * ### Delete Operation Diagram:
+   * ```
+   * Before:
+   * [1: ptr=C gen=3]
+   * free_head = 3 -> [3: free] -> END
+   *
+   * After deleting handle (3 << 32) | 1:
+   * free_head = 1 -> [1: free gen=4] -> [3: free] -> END
+   * ```
+   */
+  int handle_table_delete (struct handle_table *table, const uint64_t handle);
+
+  /*!
+   * @brief Returns the number of live objects in the table.
+   *
+   * @param table Pointer to the table.
+   * @return Number of live objects.
+   */
+  [[nodiscard]]
+  uint32_t handle_table_size (struct handle_table *table);
+
+  /*!
+   * @brief Releases every live object and frees the table.
+   *
+   * @param table Pointer to the table to destroy.
+   */
+  void handle_table_destroy (struct handle_table *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !HANDLE_TABLE_H
+
+/*!
+ * @}
+ */
@@ -109,8 +109,7 @@
 
 #include <pthread.h> // for pthread_mutex_t, pthread_cond_t
 #include <stdint.h>  // for uint32_t, int64_t
-
-// TODO: añadir métodos de backpressure, por ver conversacion de ChatGPT
+#include <sys/uio.h> // for iovec
 
 #ifdef __cplusplus
 extern "C"
@@ -172,15 +171,119 @@ extern "C"
     /*! Additional argument for the read callback. */
     void *on_readed_arg;
 
+    /*!
+     * @brief Callback for handling read events without copying the message.
+     *
+     * When set it replaces `on_readed`. A message that ends inside the
+     * buffers it was received in is described in place, one view per buffer
+     * it spans. A message that spanned several reads was already gathered
+     * into one copy, so it arrives as a single view of that copy, unless
+     * `on_read_chunk` streams it instead.
+     *
+     * The views are valid until the callback returns, unless it calls
+     * `saurion_retain`.
+     *
+     * @param fd File descriptor of the socket.
+     * @param iov Views of the message, in order.
+     * @param iovcnt Number of views.
+     * @param len Length of the message.
+     * @param arg Additional user-provided argument.
+     */
+    void (*on_readv) (const int fd, const struct iovec *const iov,
+                      const uint32_t iovcnt, const int64_t len, void *arg);
+    /*! Additional argument for the borrowed read callback. */
+    void *on_readv_arg;
+
+    /*!
+     * @brief Callback for the start of a message streamed in pieces.
+     *
+     * When `on_read_chunk` is set, a message that does not end inside the
+     * read it starts in is not gathered into one copy: it is announced here
+     * and handed over piece by piece as the reads complete, so the memory
+     * per connection stays bounded by the read buffers. Messages that fit in
+     * one read still go to `on_readed` or `on_readv`.
+     *
+     * @param fd File descriptor of the socket.
+     * @param len Length of the whole message.
+     * @param arg Additional user-provided argument.
+     */
+    void (*on_read_begin) (const int fd, const int64_t len, void *arg);
+    /*! Additional argument for the stream start callback. */
+    void *on_read_begin_arg;
+
+    /*!
+     * @brief Callback for the next piece of a streamed message.
+     *
+     * The piece is only valid until the callback returns.
+     *
+     * @param fd File descriptor of the socket.
+     * @param content Pointer to the piece of the message.
+     * @param len Length of the piece.
+     * @param arg Additional user-provided argument.
+     */
+    void (*on_read_chunk) (const int fd, const void *const content,
+                           const int64_t len, void *arg);
+    /*! Additional argument for the stream piece callback. */
+    void *on_read_chunk_arg;
+
+    /*!
+     * @brief Callback for the end of a streamed message.
+     *
+     * @param fd File descriptor of the socket.
+     * @param err 0 once the whole message was handed over, -EBADMSG when its
+     * frame was malformed, or -ECONNRESET when the connection closed before
+     * its end.
+     * @param arg Additional user-provided argument.
+     */
+    void (*on_read_end) (const int fd, const int err, void *arg);
+    /*! Additional argument for the stream end callback. */
+    void *on_read_end_arg;
+
     /*!
      * @brief Callback for handling write events.
      *
+     * Called once the whole message has been written, after as many
+     * resubmissions as short writes required.
+     *
      * @param fd File descriptor of the socket.
      * @param arg Additional user-provided argument.
      */
     void (*on_wrote) (const int fd, void *arg);
     void *on_wrote_arg; /**< Additional argument for the write callback. */
 
+    /*!
+     * @brief Callback for the completion of a `saurion_send_buf`.
+     *
+     * Once it runs the kernel no longer reads the buffer, so the caller may
+     * reuse or free it.
+     *
+     * @param fd File descriptor of the socket.
+     * @param token Token given to `saurion_send_buf`.
+     * @param err 0 when the message was written, or a negative errno.
+     * @param arg Additional user-provided argument.
+     */
+    void (*on_sent) (const int fd, void *const token, const int err,
+                     void *arg);
+    /*! Additional argument for the send completion callback. */
+    void *on_sent_arg;
+
+    /*!
+     * @brief Callback for outbound queues falling under their low-water
+     * mark.
+     *
+     * Called by a worker once the bytes queued to a connection fall to
+     * `saurion_config.send_low_water`, after a message to it was refused,
+     * dropped or blocked above `send_high_water`. When the global limit refused it, it
+     * is called with -1 once every connection together falls to
+     * `send_global_low`. It may be called again with nothing refused since.
+     *
+     * @param fd File descriptor of the socket, or -1 for the global limit.
+     * @param arg Additional user-provided argument.
+     */
+    void (*on_drain) (const int fd, void *arg);
+    /*! Additional argument for the drain callback. */
+    void *on_drain_arg;
+
     /*!
      * @brief Callback for handling socket closures.
      *
@@ -205,6 +308,220 @@ extern "C"
     void *on_error_arg;
   } __attribute__ ((aligned (PACKING_SZ)));
 
+  /*!
+   * @brief Counters describing how the event loops reap completions.
+   *
+   * `cqes / wakeups` is the average number of completions handled every time
+   * a loop wakes up.
+   */
+  struct saurion_stats
+  {
+    /*! Number of times the event loops woke up to handle completions. */
+    uint64_t wakeups;
+    /*! Number of completions handled. */
+    uint64_t cqes;
+    /*! Largest number of completions handled in a single wakeup. */
+    uint64_t max_batch;
+    /*! Operations that found their submission queue full. */
+    uint64_t sq_full;
+    /*! Operations that still found it full after submitting, and waited in
+     * the ring's backlog instead. */
+    uint64_t sq_deferred;
+    /*! Wakeups that found completions held in the kernel's overflow list
+     * because the completion queue was full. */
+    uint64_t cq_overflow;
+    /*! Completions the kernel dropped because it could not hold them. */
+    uint64_t cq_dropped;
+    /*! Messages sent with zero-copy (see `saurion_config.zc_threshold`). */
+    uint64_t zc_sends;
+    /*! Zero-copy sends the kernel had to copy anyway, as over loopback. */
+    uint64_t zc_copied;
+    /*! Writes that sent only part of their message and were resubmitted
+     * for the rest. */
+    uint64_t short_writes;
+    /*! Messages written together with the ones queued before them for the
+     * same connection. */
+    uint64_t coalesced;
+    /*! Messages found above the outbound limits: refused by
+     * `saurion_try_send`, or handled by `saurion_config.slow_consumer`. */
+    uint64_t over_limit;
+    /*! Times the reads of a connection stopped, paused or over its receive
+     * budget. */
+    uint64_t read_pauses;
+    /*! Connections closed for announcing a message above
+     * `saurion_config.max_msg_size`. */
+    uint64_t oversized;
+    /*! Messages spanning several reads whose rest was read straight into
+     * the buffer they are gathered in, instead of being copied there. */
+    uint64_t body_reads;
+    /*! Multishot receives armed: one per connection, plus one every time
+     * the kernel ends the previous one (see `saurion_config.recv_multishot`).
+     */
+    uint64_t recv_arms;
+    /*! Reads and receives that found every provided buffer retained, and
+     * waited for one to be released instead of being posted again. */
+    uint64_t buf_starved;
+  };
+
+/*!
+ * @brief Ring affinity policies for `saurion_config.affinity`.
+ *
+ * Every accepted connection is pinned to one ring, so all its reads and
+ * writes complete on the same worker thread.
+ *   - `SAURION_AFFINITY_ROUND_ROBIN` cycles through the rings.
+ *   - `SAURION_AFFINITY_LEAST_LOADED` takes the ring with the fewest live
+ *     connections.
+ *   - `SAURION_AFFINITY_HASH` hashes the socket descriptor.
+ */
+#define SAURION_AFFINITY_ROUND_ROBIN 0U
+#define SAURION_AFFINITY_LEAST_LOADED 1U
+#define SAURION_AFFINITY_HASH 2U
+
+/*!
+ * @brief Slow consumer policies (`saurion_config.slow_consumer`).
+ *
+ * What `saurion_send` and `saurion_send_buf` do with a message to a
+ * connection above `send_high_water`, or while every connection together is
+ * above `send_global_high`:
+ *   - `SAURION_SLOW_BLOCK` sleeps until the queues it is above drain to
+ *     their low-water marks, when `on_drain` is called. Workers never wait,
+ *     as they are the ones draining the queues, so messages sent from the
+ *     callbacks are queued anyway.
+ *   - `SAURION_SLOW_DROP` discards it. `saurion_send_buf` reports it to
+ *     `on_sent` with `-ENOBUFS`.
+ *   - `SAURION_SLOW_DISCONNECT` discards it as well and shuts the connection
+ *     down, which then closes like any other.
+ */
+#define SAURION_SLOW_BLOCK 0U
+#define SAURION_SLOW_DROP 1U
+#define SAURION_SLOW_DISCONNECT 2U
+
+  /*!
+   * @brief Custom ring affinity policy.
+   *
+   * @param fd Socket descriptor of the accepted connection.
+   * @param conns Live connections pinned to every ring.
+   * @param n_rings Number of rings, and entries in `conns`.
+   * @param arg User-defined argument (`saurion_config.pick_ring_arg`).
+   * @return Index of the ring the connection is pinned to. It is taken
+   * modulo `n_rings`.
+   */
+  typedef uint32_t (*saurion_pick_ring) (const int fd, const uint32_t *conns,
+                                         const uint32_t n_rings, void *arg);
+
+  /*!
+   * @brief Runtime settings used by `saurion_create_ex`.
+   *
+   * Use `saurion_config_default` to start from the build-time defaults and
+   * override only the fields that need to change.
+   */
+  struct saurion_config
+  {
+    /*! Number of worker threads, clamped to `[2, NUM_CORES]`. */
+    uint32_t n_threads;
+    /*! Submission queue entries of every ring (`SAURION_RING_SIZE`). */
+    uint32_t ring_entries;
+    /*! Completion queue entries of every ring, or 0 for the kernel default
+     * (twice `ring_entries`). */
+    uint32_t cq_entries;
+    /*! Size in bytes of the buffers carried by the requests (`CHUNK_SZ`). */
+    uint64_t chunk_sz;
+    /*! Extra `IORING_SETUP_*` flags passed when creating the rings.
+     * `IORING_SETUP_SQPOLL` gives every ring a kernel submission thread
+     * (`SQPOLL`). */
+    uint32_t setup_flags;
+    /*! Milliseconds the submission threads spin before sleeping
+     * (`SQPOLL_IDLE`). Only used with `IORING_SETUP_SQPOLL`. */
+    uint32_t sq_thread_idle;
+    /*! CPU the submission thread of the first ring is pinned to; ring `i` is
+     * pinned to `(sq_thread_cpu + i) % NUM_CORES`. Negative leaves them
+     * unpinned (`SQPOLL_CPU`). Only used with `IORING_SETUP_SQPOLL`. */
+    int32_t sq_thread_cpu;
+    /*! Non-zero makes every ring private to its worker thread
+     * (`SINGLE_ISSUER`). The rings are then created with
+     * `IORING_SETUP_SINGLE_ISSUER` and, unless SQPOLL is used,
+     * `IORING_SETUP_DEFER_TASKRUN` and `IORING_SETUP_COOP_TASKRUN`. Other
+     * threads hand their work to the owner through a per-ring inbox.
+     * `tests/owner_bench.cpp` has measured no improvement over shared rings
+     * so far: round-trip latency and context switches stay within run-to-run
+     * noise. */
+    uint32_t single_issuer;
+    /*! Policy pinning accepted connections to a ring, one of the
+     * `SAURION_AFFINITY_*` values (`RING_AFFINITY`). */
+    uint32_t affinity;
+    /*! Custom policy used instead of `affinity` when not `NULL`. */
+    saurion_pick_ring pick_ring;
+    /*! User-defined argument passed to `pick_ring`. */
+    void *pick_ring_arg;
+    /*! Non-zero makes `saurion_set_sockets` open one `SO_REUSEPORT`
+     * listener per ring, so every worker accepts its own connections and
+     * keeps them on its ring (`REUSEPORT`). `affinity` and `pick_ring` are
+     * then ignored. */
+    uint32_t reuseport;
+    /*! Largest submission queue a ring may grow to with
+     * `io_uring_resize_rings` while operations wait in its backlog, or 0 to
+     * keep `ring_entries` (`SAURION_RING_MAX`). Needs liburing 2.9 and a
+     * kernel accepting the resize, which currently means single issuer
+     * rings without SQPOLL. */
+    uint32_t max_ring_entries;
+    /*! Buffers in every ring's io_uring provided buffer ring, a power of two
+     * up to 32768. Reads then take a buffer from it when data arrives
+     * instead of every pending read owning one. 0 disables it
+     * (`BUF_RING_ENTRIES`), as does a kernel without buffer rings. */
+    uint32_t buf_ring_entries;
+    /*! Non-zero keeps one multishot recv armed per connection on the buffer
+     * ring, re-armed only when the kernel ends it; 0 re-arms a read after
+     * every message (`RECV_MULTISHOT`). */
+    uint32_t recv_multishot;
+    /*! Messages of at least this many bytes, framing included, are sent
+     * with `IORING_OP_SENDMSG_ZC`: the kernel transmits from their buffers
+     * instead of copying them, and they are only released once its
+     * notification arrives. 0 disables it (`SEND_ZC_THRESHOLD`), as does a
+     * kernel without the operation. */
+    uint64_t zc_threshold;
+    /*! Bytes a write gathers from the messages queued to a connection
+     * before the rest wait for the next one; at least one message always
+     * goes. 0 for no limit but the iovecs of a write
+     * (`SEND_COALESCE_MAX`). */
+    uint64_t send_coalesce_max;
+    /*! Bytes queued to a connection, framing included, above which new
+     * messages are refused by `saurion_try_send` and handled by
+     * `slow_consumer`, or 0 for no limit (`SEND_HIGH_WATER`). Messages are
+     * admitted while it is not reached, so it may be exceeded by one of
+     * them per sending thread. */
+    uint64_t send_high_water;
+    /*! Bytes queued to a connection at which `on_drain` is called, below
+     * `send_high_water` (`SEND_LOW_WATER`). */
+    uint64_t send_low_water;
+    /*! Like `send_high_water`, for the bytes queued to every connection
+     * together (`SEND_GLOBAL_HIGH`). */
+    uint64_t send_global_high;
+    /*! Like `send_low_water`, for the bytes queued to every connection
+     * together (`SEND_GLOBAL_LOW`). */
+    uint64_t send_global_low;
+    /*! What to do with the messages above the limits, one of the
+     * `SAURION_SLOW_*` values (`SLOW_CONSUMER`). */
+    uint32_t slow_consumer;
+    /*! Messages of a connection retained with `saurion_retain` and not
+     * released yet at which its reads stop, as with `saurion_pause_read`,
+     * until a release takes it under again. 0 for no limit
+     * (`READ_MAX_MSGS`). */
+    uint32_t read_max_msgs;
+    /*! Like `read_max_msgs`, for the bytes of those messages
+     * (`READ_MAX_BYTES`). */
+    uint64_t read_max_bytes;
+    /*! Like `read_max_msgs`, for the messages of every connection together,
+     * which stops reading from all of them (`READ_GLOBAL_MSGS`). */
+    uint32_t read_global_msgs;
+    /*! Like `read_global_msgs`, for the bytes of those messages
+     * (`READ_GLOBAL_BYTES`). */
+    uint64_t read_global_bytes;
+    /*! Largest message accepted from a peer. A longer one is reported to
+     * `on_error` and closes the connection, before anything is allocated
+     * for it. 0 for no limit (`MAX_MSG_SIZE`). */
+    uint64_t max_msg_size;
+  };
+
   /*!
    * @brief Main structure for managing io_uring and socket events.
    *
@@ -216,14 +533,39 @@ extern "C"
   {
     /*! Array of io_uring structures for managing the event queue. */
     struct io_uring *rings;
-    /*! Array of mutexes to protect the io_uring rings. */
+    /*! Array of mutexes to protect the io_uring rings and their counters.
+     * Rings owned by a single worker (see `inboxes`) are not locked. */
     pthread_mutex_t *m_rings;
     /*! Server socket descriptor for accepting connections. */
     int ss;
     /*! Eventfd descriptors used for internal signaling between threads. */
     int *efds;
-    /*! Linked list for storing active requests. */
-    struct Node *list;
+    /*! Per-ring handle tables storing the in-flight requests. */
+    struct handle_table **tables;
+    /*! Per-ring slabs recycling the request objects and their buffers. */
+    struct slab **slabs;
+    /*! Per-ring slabs of the bare requests framing the buffers of
+     * `saurion_send_buf` and reading the rest of long messages. */
+    struct slab **sends;
+    /*! Per-ring slabs of the message copies handed to `on_readed`, and of
+     * the messages posted to the ring's inbox. */
+    struct slab **copies;
+    /*! Per-ring pools of the `config.chunk_sz` buffers carried by the
+     * requests. */
+    struct chunk_pool **chunks;
+    /*! Per-ring number of chunk pool regions registered as fixed buffers. */
+    uint32_t *fixed;
+    /*! Per-ring provided buffer rings used by reads, or `NULL` when every
+     * pending read owns its buffer (see `config.buf_ring_entries`). */
+    struct provided_buffers **provided;
+    /*! Per-ring completion counters, protected by `m_rings`. */
+    struct saurion_stats *stats;
+    /*! Per-ring lock-free queues of work posted to the ring's worker by
+     * other threads. */
+    struct inbox *inboxes;
+    /*! Per-ring operations prepared while the submission queue was full,
+     * moved to it in order every time the ring is flushed. */
+    struct sqe_backlog *backlogs;
     /*! Mutex to protect the state of the structure. */
     pthread_mutex_t status_m;
     /*! Condition variable to signal changes in the structure's state. */
@@ -236,6 +578,52 @@ extern "C"
     uint32_t n_threads;
     /*! Index of the next io_uring ring to which an event will be added. */
     uint32_t next;
+    /*! Ring every connection is pinned to, plus one, indexed by socket
+     * descriptor (0 for descriptors without a connection). */
+    uint32_t *fd_ring;
+    /*! Entries in `fd_ring`. Descriptors past the end are pinned by hash. */
+    uint32_t fd_ring_sz;
+    /*! Messages waiting to be written to every pinned connection, indexed
+     * by socket descriptor like `fd_ring`. */
+    struct outbound *outbound;
+    /*! Bytes queued to every connection together, while
+     * `config.send_global_high` is set. */
+    uint64_t pending;
+    /*! Non-zero once a message was refused by the global limit, until
+     * `on_drain` reports it fell under `config.send_global_low`. */
+    uint32_t pending_over;
+    /*! Mutex of `drain_c`. */
+    pthread_mutex_t drain_m;
+    /*! Signaled along with `on_drain`, waking the threads blocked by
+     * `SAURION_SLOW_BLOCK`. */
+    pthread_cond_t drain_c;
+    /*! Threads waiting on `drain_c`. */
+    uint32_t drain_waiters;
+    /*! Read state and receive budget of every pinned connection, indexed by
+     * socket descriptor like `fd_ring`. */
+    struct inbound *inbound;
+    /*! Per-ring lists of the connections whose reads are parked, linked
+     * through `inbound` by socket descriptor, or -1 when empty. Only the
+     * worker of the ring uses its list. */
+    int *parked;
+    /*! Per-ring lists of the connections waiting for a provided buffer to
+     * be released, linked like `parked`. Each buffer put back in the ring
+     * resumes one of them. */
+    int *starved;
+    /*! Bytes of the retained messages of every connection together, while
+     * a receive budget is set. */
+    uint64_t held_bytes;
+    /*! Retained messages of every connection together, while a receive
+     * budget is set. */
+    uint32_t held_msgs;
+    /*! Live connections pinned to every ring. */
+    uint32_t *conns;
+    /*! Per-ring listening sockets opened by `saurion_set_sockets` in
+     * `config.reuseport` mode, or `NULL` when only ring 0 accepts on `ss`.
+     * The first entry is `ss`. */
+    int *listeners;
+    /*! Settings the instance was created with. */
+    struct saurion_config config;
 
     struct saurion_callbacks cb;
   } __attribute__ ((aligned (PACKING_SZ)));
@@ -251,6 +639,26 @@ extern "C"
    */
   int saurion_set_socket (const int p);
 
+  /*!
+   * @public
+   * @brief Creates the listening sockets of an instance.
+   *
+   * Without `config.reuseport` this stores `saurion_set_socket (p)` in
+   * `s->ss`. With it, one `SO_REUSEPORT` socket is bound to `p` for every
+   * ring. The kernel then spreads incoming connections among them, and
+   * every worker runs its own accept loop. `s->ss` is set to the first
+   * socket and must be closed by the caller as usual. The others are closed
+   * by `saurion_destroy`.
+   *
+   * Must be called before `saurion_start`.
+   *
+   * @param s Pointer to the `saurion` structure.
+   * @param p port
+   * @return int Returns 1 on success, or 0 if a socket cannot be created.
+   */
+  [[nodiscard]]
+  int saurion_set_sockets (struct saurion *s, const int p);
+
   /*!
    * @public
    * @brief Creates an instance of the `saurion` structure.
@@ -266,6 +674,31 @@ extern "C"
   [[nodiscard]]
   struct saurion *saurion_create (uint32_t n_threads);
 
+  /*!
+   * @public
+   * @brief Fills a `saurion_config` with the build-time defaults.
+   *
+   * @param cfg Configuration to fill.
+   */
+  void saurion_config_default (struct saurion_config *cfg);
+
+  /*!
+   * @public
+   * @brief Creates an instance of the `saurion` structure from a runtime
+   * configuration.
+   *
+   * Behaves like `saurion_create`, but the ring sizes, the chunk size and the
+   * io_uring setup flags are taken from `cfg` instead of the build-time
+   * defaults. The configuration is copied, so `cfg` may be released once the
+   * call returns.
+   *
+   * @param cfg Settings of the new instance.
+   * @return struct saurion* A pointer to the newly created `saurion`
+   * structure, or NULL if `cfg` is invalid or an error occurs.
+   */
+  [[nodiscard]]
+  struct saurion *saurion_create_ex (const struct saurion_config *cfg);
+
   /*!
    * @public
    * @brief Starts event processing in the `saurion` structure.
@@ -315,12 +748,144 @@ extern "C"
    * using the io_uring event queue. The message is split into iovec structures
    * for efficient transmission and sent asynchronously.
    *
+   * Called from a `saurion` callback, the send is submitted together with the
+   * rest of the operations prepared while handling the current completions.
+   * Called from any other thread, the message is copied into the inbox of a
+   * worker without taking any lock, and that worker submits it with the rest
+   * of its batch. The worker is only woken when its inbox was empty.
+   *
+   * Messages to a connection are written in the order they were sent. While
+   * a write to it is in flight, new ones wait in its queue and all of them
+   * go out in a single `writev` once that write completes. Above the
+   * outbound limits of `saurion_config`, the message is handled according
+   * to its `slow_consumer` policy. Once the connection is closed, messages
+   * sent while the ones queued before are still being written are dropped,
+   * so they never go out ahead of them.
+   *
    * @param s Pointer to the `saurion` structure.
    * @param fd File descriptor of the socket to which the message will be sent.
    * @param msg Pointer to the character string (message) to be sent.
    */
   void saurion_send (struct saurion *s, const int fd, const char *const msg);
 
+  /*!
+   * @public
+   * @brief Sends a message unless the connection is above its limits.
+   *
+   * Behaves like `saurion_send` while the bytes queued to \p fd are under
+   * `saurion_config.send_high_water`, and those queued to every connection
+   * under `send_global_high`. Otherwise the message is not sent, whatever
+   * the `slow_consumer` policy, and `on_drain` reports when to try again.
+   *
+   * @param s Pointer to the `saurion` structure.
+   * @param fd File descriptor of the socket to which the message will be sent.
+   * @param msg Pointer to the character string (message) to be sent.
+   *
+   * @retval 0 if the message was sent.
+   * @retval EAGAIN if it was refused.
+   * @retval EPIPE if the connection is closed and still writing the
+   * messages queued before.
+   */
+  [[nodiscard]]
+  int saurion_try_send (struct saurion *s, const int fd,
+                        const char *const msg);
+
+  /*!
+   * @public
+   * @brief Sends a binary message without copying it.
+   *
+   * The length header and the footer are written from the request itself and
+   * the payload straight from \p buf, in a single `writev`. The buffer must
+   * stay valid and unchanged until `on_sent` reports \p token, whether the
+   * write succeeded or not. Like `saurion_send`, it may be called from any
+   * thread and follows `saurion_config.slow_consumer` above the outbound
+   * limits. Dropped like in `saurion_send` once the connection is closed,
+   * it is reported to `on_sent` with `-EPIPE`.
+   *
+   * @param s Pointer to the `saurion` structure.
+   * @param fd File descriptor of the socket to which the message will be sent.
+   * @param buf Payload of the message.
+   * @param len Number of bytes of \p buf to send.
+   * @param token Opaque value passed back to `on_sent`.
+   */
+  void saurion_send_buf (struct saurion *s, const int fd, const void *buf,
+                         size_t len, void *token);
+
+  /*!
+   * @public
+   * @brief Stops reading from a connection until `saurion_resume_read`.
+   *
+   * Once its socket buffer fills up, TCP flow control makes the peer wait.
+   * With the multishot receives of the provided buffer rings the pending
+   * receive is canceled; otherwise the read already posted still delivers
+   * what it gets. May be called from any thread, and takes effect once the
+   * worker of the connection handles it.
+   *
+   * @param s Pointer to the `saurion` structure.
+   * @param fd File descriptor of the socket.
+   */
+  void saurion_pause_read (struct saurion *s, const int fd);
+
+  /*!
+   * @public
+   * @brief Reads from a connection paused by `saurion_pause_read` again.
+   *
+   * Reads stay stopped while the connection, or the instance, is over the
+   * receive budgets of `saurion_config`.
+   *
+   * @param s Pointer to the `saurion` structure.
+   * @param fd File descriptor of the socket.
+   */
+  void saurion_resume_read (struct saurion *s, const int fd);
+
+  /*!
+   * @brief Keeps the views of a message alive past its `on_readv` callback.
+   *
+   * Opaque; obtained from `saurion_retain` and given back with
+   * `saurion_release`.
+   */
+  struct saurion_lease;
+
+  /*!
+   * @public
+   * @brief Keeps the views passed to the running `on_readv` callback valid
+   * after it returns.
+   *
+   * While a lease is held, the buffer the message sits in is not reused for
+   * new reads, and the message counts against the receive budgets of
+   * `saurion_config`. Calling it again within the same callback returns the
+   * same lease, which then needs one more `saurion_release`.
+   *
+   * @param s Pointer to the `saurion` structure.
+   * @return struct saurion_lease* The lease, or NULL when not called from an
+   * `on_readv` callback or on allocation failure.
+   */
+  [[nodiscard]]
+  struct saurion_lease *saurion_retain (struct saurion *s);
+
+  /*!
+   * @public
+   * @brief Gives back a lease returned by `saurion_retain`.
+   *
+   * May be called from any thread. Leases must be released before
+   * `saurion_stop`.
+   *
+   * @param s Pointer to the `saurion` structure.
+   * @param lease Lease to release, or NULL.
+   */
+  void saurion_release (struct saurion *s, struct saurion_lease *lease);
+
+  /*!
+   * @public
+   * @brief Reads the completion counters of every ring added together.
+   *
+   * `max_batch` is the largest batch seen by any ring.
+   *
+   * @param s Pointer to the `saurion` structure.
+   * @param stats Destination of the counters.
+   */
+  void saurion_get_stats (struct saurion *s, struct saurion_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 
 #include <bits/types/struct_iovec.h> // for struct iovec
 #include <stdint.h>                  // for uint64_t, uint8_t
+#include <sys/socket.h>              // for struct msghdr
 
 #ifdef __cplusplus
 extern "C"
@@ -23,12 +24,25 @@ extern "C"
     uint64_t next_offset;
     int event_type;
     uint64_t iovec_count;
+    uint64_t iovec_owned;
     int client_socket;
+    uint64_t handle;
+    int64_t buf_index;
+    uint32_t retained;
+    uint32_t streaming;
+    void *token;
+    uint64_t frame;
+    int64_t sent;
+    struct request *next;
+    struct outbound *queue;
+    struct msghdr msg;
     struct iovec iov[];
   };
 #pragma GCC diagnostic pop
 
-  struct Node;
+  struct handle_table;
+  struct slab;
+  struct chunk_pool;
   /*! @endcond */
 
   /*!
@@ -40,32 +54,35 @@ extern "C"
    * This function allocates memory for each `struct iovec`. Every `struct
    * iovec` consists of two member variables:
    *   - `iov_base`, a `void *` array that will hold the data. All of them will
-   *     allocate the same amount of memory (CHUNK_SZ) to avoid memory
+   *     allocate the same amount of memory (\p chunk_sz) to avoid memory
    * fragmentation.
    *   - `iov_len`, an integer representing the size of the data stored in the
-   *     `iovec`. The data size is CHUNK_SZ unless it's the last one, in which
-   *     case it will hold the remaining bytes. In addition to initialization,
-   *     the function adds the pointers to the allocated memory into a child
-   * array to simplify memory deallocation later on.
+   *     `iovec`. The data size is \p chunk_sz unless it's the last one, in
+   *     which case it will hold the remaining bytes. In addition to
+   *     initialization, the function adds the pointers to the allocated memory
+   *     into a child array to simplify memory deallocation later on.
    *
    * @param iov Structure to initialize.
    * @param amount Total number of `iovec` to initialize.
    * @param pos Current position of the `iovec` within the total `iovec` (\p
    * amount).
    * @param size Total size of the data to be stored in the `iovec`.
-   * @param chd_ptr Array to hold the pointers to the allocated memory.
+   * @param chunk_sz Size in bytes of every buffer.
+   * @param chd_ptr Optional array to hold the pointers to the allocated
+   * memory. May be `NULL`.
    *
    * @retval ERROR_CODE if there was an error during memory allocation.
    * @retval SUCCESS_CODE if the operation was successful.
    *
    * @note The last `iovec` will allocate only the remaining bytes if the total
-   * size is not a multiple of CHUNK_SZ.
+   * size is not a multiple of \p chunk_sz.
    *
    * @{
    */
   [[nodiscard]]
   int allocate_iovec (struct iovec *iov, const uint64_t amount,
-                      const uint64_t pos, const uint64_t size, void **chd_ptr);
+                      const uint64_t pos, const uint64_t size,
+                      const uint64_t chunk_sz, void **chd_ptr);
 
   /*!
    * @private
@@ -84,6 +101,7 @@ extern "C"
    * @param msg Pointer to the message to be split across the `iovec`
    * structures.
    * @param size The total size of the message.
+   * @param chunk_sz Size in bytes of every `iovec` buffer.
    * @param h A flag (header flag) that indicates whether special handling is
    * needed for the first `iovec` (adds the message size as a header) or for
    * the last chunk.
@@ -105,7 +123,8 @@ extern "C"
   [[nodiscard]]
   int initialize_iovec (struct iovec *iov, const uint64_t amount,
                         const uint64_t pos, const void *msg,
-                        const uint64_t size, const uint8_t h);
+                        const uint64_t size, const uint64_t chunk_sz,
+                        const uint8_t h);
 
   /**
    * @private
@@ -115,16 +134,20 @@ extern "C"
    * This function configures a request structure that will be used to send or
    * receive data through liburing's submission queues. It allocates the
    * necessary iovec structures to split the data into manageable chunks, and
-   * optionally adds a header if specified. The request is inserted into a list
-   * tracking active requests for proper memory management and deallocation
-   * upon completion.
+   * optionally adds a header if specified. The request is inserted into the
+   * handle table of the ring it will be submitted on, and the resulting handle
+   * is stored in `handle` so the completion can retire it in constant time.
+   * The request is taken from the slab of that ring and reuses the iovec
+   * buffers it already carries; `iovec_owned` holds how many there are.
    *
    * @param r Pointer to a pointer to the request structure. If NULL, a new
    * request is created.
-   * @param l Pointer to the list of active requests (Node list) where the
-   * request will be inserted.
+   * @param p Slab of the ring the request is taken from. See
+   * `request_slab_create`.
+   * @param t Handle table of the ring where the request will be inserted.
    * @param s Size of the data to be handled. Adjusted if the header flag (h)
    * is true.
+   * @param c Size in bytes of every iovec buffer (`saurion_config.chunk_sz`).
    * @param m Pointer to the memory block containing the data to be processed.
    * @param h Header flag. If true, a header (sizeof(uint64_t) + 1) is added to
    * the iovec data.
@@ -132,18 +155,46 @@ extern "C"
    * @return int Returns SUCCESS_CODE on success, or ERROR_CODE on failure
    * (memory allocation issues or insertion failure).
    * @retval SUCCESS_CODE The request was successfully set up and inserted into
-   * the list.
+   * the table.
    * @retval ERROR_CODE Memory allocation failed, or there was an error
-   * inserting the request into the list.
+   * inserting the request into the table.
    *
    * @note The function handles memory allocation for the request and iovec
    * structures, and ensures that the memory is freed properly if an error
-   * occurs. Pointers to the iovec blocks (children_ptr) are managed and used
-   * for proper memory deallocation.
+   * occurs. Deleting the handle from the table releases the request through
+   * `free_request`.
    */
   [[nodiscard]]
-  int set_request (struct request **r, struct Node **l, uint64_t s,
-                   const void *m, uint8_t h);
+  int set_request (struct request **r, struct slab *p, struct handle_table *t,
+                   uint64_t s, uint64_t c, const void *m, uint8_t h);
+
+  /*!
+   * @private
+   * @brief Creates a slab for `struct request` objects.
+   *
+   * Requests are grouped by the number of iovecs they hold. Every request
+   * gets its \p chunk_sz buffers when it is first created and keeps them
+   * while it is cached, so a warmed up ring neither allocates requests nor
+   * buffers.
+   *
+   * @param pool Pool the buffers are taken from and returned to. If `NULL`,
+   * they are allocated with `malloc`.
+   * @param chunk_sz Size in bytes of every buffer
+   * (`saurion_config.chunk_sz`). The chunks of \p pool must be at least as
+   * large.
+   * @return A pointer to the created slab, or `NULL` if creation fails.
+   */
+  [[nodiscard]]
+  struct slab *request_slab_create (struct chunk_pool *pool,
+                                    const uint64_t chunk_sz);
+
+  /*!
+   * @private
+   * @brief Destroys a slab created by `request_slab_create`.
+   *
+   * @param slab Pointer to the slab. May be `NULL`.
+   */
+  void request_slab_destroy (struct slab *slab);
 
   /**
    * @private
@@ -185,8 +236,16 @@ extern "C"
   [[nodiscard]]
   int read_chunk (void **dest, uint64_t *len, struct request *const req);
 
-  void free_request (struct request *req, void **children_ptr,
-                     uint64_t amount);
+  /**
+   * @private
+   * @brief Returns a request, with the iovec buffers it owns, to its slab.
+   *
+   * This is the release callback of the per-ring handle tables. The buffer
+   * pointed to by `prev` is not owned by the request and is left untouched.
+   *
+   * @param req Pointer to the `struct request` to free.
+   */
+  void free_request (void *req);
 /*!
  * @}
  */
@@ -21,12 +21,22 @@
  * +-------------------+
  * |      Saurion      |
  * +-------------------+
+ * | + set_sockets(p)  |
  * | + init()          |
  * | + stop()          |
  * | + send(fd, msg)   |
+ * | + send_buf(...)   |
+ * | + try_send(...)   |
+ * | + pause_read(fd)  |
+ * | + resume_read(fd) |
  * | + on_connected()  |
  * | + on_readed()     |
+ * | + on_read_begin() |
+ * | + on_read_chunk() |
+ * | + on_read_end()   |
  * | + on_wrote()      |
+ * | + on_sent()       |
+ * | + on_drain()      |
  * | + on_closed()     |
  * | + on_error()      |
  * +-------------------+
@@ -79,9 +89,14 @@
 #ifndef SAURION_HPP
 #define SAURION_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <stdint.h> // for uint32_t, int64_t
 
+struct saurion_config;
+struct saurion_lease;
+struct iovec;
+
 /*!
  * @brief A class for managing network connections with callback-based event
  * handling.
@@ -110,6 +125,43 @@ public:
    */
   using ReadedCb
       = void (*) (const int, const void *const, const int64_t, void *);
+  /*!
+   * @typedef ReadvCb
+   * @brief Callback type for data received events with borrowed views.
+   * @param fd File descriptor of the socket.
+   * @param iov Views of the received data.
+   * @param iovcnt Number of views.
+   * @param len Length of the received data.
+   * @param arg User-defined argument.
+   */
+  using ReadvCb = void (*) (const int, const struct iovec *const,
+                            const uint32_t, const int64_t, void *);
+  /*!
+   * @typedef ReadBeginCb
+   * @brief Callback type for the start of a streamed message.
+   * @param fd File descriptor of the socket.
+   * @param len Length of the whole message.
+   * @param arg User-defined argument.
+   */
+  using ReadBeginCb = void (*) (const int, const int64_t, void *);
+  /*!
+   * @typedef ReadChunkCb
+   * @brief Callback type for the next piece of a streamed message.
+   * @param fd File descriptor of the socket.
+   * @param content Piece of the message.
+   * @param len Length of the piece.
+   * @param arg User-defined argument.
+   */
+  using ReadChunkCb
+      = void (*) (const int, const void *const, const int64_t, void *);
+  /*!
+   * @typedef ReadEndCb
+   * @brief Callback type for the end of a streamed message.
+   * @param fd File descriptor of the socket.
+   * @param err 0 when it was complete, or a negative errno.
+   * @param arg User-defined argument.
+   */
+  using ReadEndCb = void (*) (const int, const int, void *);
   /*!
    * @typedef WroteCb
    * @brief Callback type for data sent events.
@@ -117,6 +169,23 @@ public:
    * @param arg User-defined argument.
    */
   using WroteCb = void (*) (const int, void *);
+  /*!
+   * @typedef SentCb
+   * @brief Callback type for the completion of `send_buf`.
+   * @param fd File descriptor of the socket.
+   * @param token Token given to `send_buf`.
+   * @param err 0 on success, or a negative errno.
+   * @param arg User-defined argument.
+   */
+  using SentCb = void (*) (const int, void *const, const int, void *);
+  /*!
+   * @typedef DrainCb
+   * @brief Callback type for outbound queues falling under their low-water
+   * mark.
+   * @param fd File descriptor of the socket, or -1 for the global limit.
+   * @param arg User-defined argument.
+   */
+  using DrainCb = void (*) (const int, void *);
   /*!
    * @typedef ClosedCb
    * @brief Callback type for connection closed events.
@@ -139,8 +208,19 @@ public:
    * @brief Constructs a `Saurion` instance.
    * @param thds Number of threads for handling connections.
    * @param sck Listening socket file descriptor.
+   * @throws std::runtime_error If the instance cannot be created. `sck` is
+   * then left open.
+   */
+  explicit Saurion (const uint32_t thds, const int sck);
+  /*!
+   * @brief Constructs a `Saurion` instance from a runtime configuration.
+   * @param cfg Ring sizes, chunk size, setup flags and number of threads.
+   * See `saurion_create_ex`.
+   * @param sck Listening socket file descriptor.
+   * @throws std::runtime_error If `cfg` is rejected by `saurion_create_ex`
+   * or the instance cannot be created. `sck` is then left open.
    */
-  explicit Saurion (const uint32_t thds, const int sck) noexcept;
+  explicit Saurion (const struct saurion_config &cfg, const int sck);
   /*!
    * @brief Destroys the `Saurion` instance, releasing resources.
    */
@@ -151,6 +231,16 @@ public:
   Saurion &operator= (const Saurion &) = delete;
   Saurion &operator= (Saurion &&) = delete;
 
+  /*!
+   * @brief Opens the listening sockets on a port, closing the socket given
+   * to the constructor. See `saurion_set_sockets`: with
+   * `saurion_config.reuseport` every ring accepts on its own socket.
+   *
+   * Must be called before `init`.
+   * @param port Port to listen on.
+   * @throws std::runtime_error If a socket cannot be created.
+   */
+  void set_sockets (const int port);
   /*!
    * @brief Initializes the server and starts listening for connections.
    */
@@ -174,6 +264,39 @@ public:
    * @return Pointer to the `Saurion` instance for chaining.
    */
   Saurion *on_readed (ReadedCb ncb, void *arg) noexcept;
+  /*!
+   * @brief Sets the callback for data received events, replacing
+   * `on_readed` with views of the data where it was received. See
+   * `saurion_callbacks.on_readv`.
+   * @param ncb The callback function.
+   * @param arg User-defined argument for the callback.
+   * @return Pointer to the `Saurion` instance for chaining.
+   */
+  Saurion *on_readv (ReadvCb ncb, void *arg) noexcept;
+  /*!
+   * @brief Sets the callback for the start of a message streamed in pieces.
+   * See `saurion_callbacks.on_read_begin`.
+   * @param ncb The callback function.
+   * @param arg User-defined argument for the callback.
+   * @return Pointer to the `Saurion` instance for chaining.
+   */
+  Saurion *on_read_begin (ReadBeginCb ncb, void *arg) noexcept;
+  /*!
+   * @brief Sets the callback for the pieces of streamed messages, which
+   * turns streaming on. See `saurion_callbacks.on_read_chunk`.
+   * @param ncb The callback function.
+   * @param arg User-defined argument for the callback.
+   * @return Pointer to the `Saurion` instance for chaining.
+   */
+  Saurion *on_read_chunk (ReadChunkCb ncb, void *arg) noexcept;
+  /*!
+   * @brief Sets the callback for the end of a streamed message. See
+   * `saurion_callbacks.on_read_end`.
+   * @param ncb The callback function.
+   * @param arg User-defined argument for the callback.
+   * @return Pointer to the `Saurion` instance for chaining.
+   */
+  Saurion *on_read_end (ReadEndCb ncb, void *arg) noexcept;
   /*!
    * @brief Sets the callback for data sent events.
    * @param ncb The callback function.
@@ -181,6 +304,21 @@ public:
    * @return Pointer to the `Saurion` instance for chaining.
    */
   Saurion *on_wrote (WroteCb ncb, void *arg) noexcept;
+  /*!
+   * @brief Sets the callback for `send_buf` completions.
+   * @param ncb The callback function.
+   * @param arg User-defined argument for the callback.
+   * @return Pointer to the `Saurion` instance for chaining.
+   */
+  Saurion *on_sent (SentCb ncb, void *arg) noexcept;
+  /*!
+   * @brief Sets the callback for outbound queues falling under their
+   * low-water mark. See `saurion_callbacks.on_drain`.
+   * @param ncb The callback function.
+   * @param arg User-defined argument for the callback.
+   * @return Pointer to the `Saurion` instance for chaining.
+   */
+  Saurion *on_drain (DrainCb ncb, void *arg) noexcept;
   /*!
    * @brief Sets the callback for connection closed events.
    * @param ncb The callback function.
@@ -202,6 +340,47 @@ public:
    * @param msg Pointer to the message to send.
    */
   void send (const int fd, const char *const msg) noexcept;
+  /*!
+   * @brief Sends a binary message without copying it. See
+   * `saurion_send_buf`.
+   * @param fd File descriptor to send the message to.
+   * @param buf Payload, kept valid until `on_sent` reports \p token.
+   * @param len Length of the payload.
+   * @param token Opaque value passed back to `on_sent`.
+   */
+  void send_buf (const int fd, const void *const buf, const size_t len,
+                 void *const token) noexcept;
+  /*!
+   * @brief Sends a message unless the connection is above its outbound
+   * limits. See `saurion_try_send`.
+   * @param fd File descriptor to send the message to.
+   * @param msg Pointer to the message to send.
+   * @return 0 if the message was sent, EAGAIN if it was refused, or EPIPE if
+   * the connection is closed and still writing the messages before it.
+   */
+  [[nodiscard]] int try_send (const int fd, const char *const msg) noexcept;
+  /*!
+   * @brief Stops reading from a connection. See `saurion_pause_read`.
+   * @param fd File descriptor of the connection.
+   */
+  void pause_read (const int fd) noexcept;
+  /*!
+   * @brief Reads from a paused connection again. See
+   * `saurion_resume_read`.
+   * @param fd File descriptor of the connection.
+   */
+  void resume_read (const int fd) noexcept;
+  /*!
+   * @brief Keeps the views of the running `on_readv` callback valid. See
+   * `saurion_retain`.
+   * @return The lease, or nullptr outside `on_readv`.
+   */
+  [[nodiscard]] struct saurion_lease *retain () noexcept;
+  /*!
+   * @brief Gives back a lease returned by `retain`.
+   * @param lease Lease to release.
+   */
+  void release (struct saurion_lease *lease) noexcept;
 
 private:
   struct saurion *s; //!< Pointer to the underlying `saurion` structure.
@@ -0,0 +1,171 @@
+/*!
+ * @defgroup Slab
+ *
+ * @brief A module for recycling variable-length objects by size class.
+ *
+ * A slab hands out objects made of a fixed header followed by a run of
+ * equally sized items, like a structure ending in a flexible array member.
+ * Requests are rounded up to a power-of-two item count and every class keeps
+ * a free list of released objects, so once the working set has been reached
+ * allocating and releasing an object never reaches the system allocator.
+ *
+ * Released objects keep their contents. The `init` callback runs only when an
+ * object is created and `fini` only when it is finally freed, so resources
+ * attached to an object by `init` (such as data buffers) are recycled along
+ * with it.
+ *
+ * Each slab has its own mutex: slabs owned by different io_uring rings never
+ * contend with each other. An object remembers the slab it came from, so it
+ * can be released from any thread without knowing its origin.
+ *
+ * ### General Diagram of the Slab:
+ *
+ * ```
+ * class 0 (1 item):   free -> [hdr|obj] -> [hdr|obj] -> NULL
+ * class 1 (2 items):  free -> NULL
+ * class 2 (4 items):  free -> [hdr|obj] -> NULL
+ * ...
+ * oversize:           allocated and freed on demand
+ *
+ * [hdr|obj]: hdr = { owner slab, class, next }  obj = header + items[]
+ * ```
+ *
+ * ### Example Usage:
+ *
+ * ```c
+ * #include "slab.h"
+ *
+ * struct msg { uint64_t len; char data[]; };
+ *
+ * int main() {
+ *     struct slab *slab = slab_create(sizeof(struct msg), 1, 8, 64, NULL,
+ *                                     NULL, NULL);
+ *
+ *     struct msg *m = slab_alloc(slab, 100); // room for 128 bytes
+ *     slab_free(m);                          // cached for the next alloc
+ *
+ *     slab_destroy(slab);
+ *     return 0;
+ * }
+ * ```
+ *
+ * @author Israel
+ * @date 2024
+ *
+ * @{
+ */
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stdint.h> // for uint64_t, uint32_t
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /*!
+   * @struct slab
+   * @brief Represents a set of per-class caches of released objects.
+   */
+  struct slab;
+
+  /*!
+   * @brief Counters describing how a slab served its allocations.
+   */
+  struct slab_stats
+  {
+    /*! Number of objects handed out. */
+    uint64_t allocs;
+    /*! Number of objects created through the system allocator. */
+    uint64_t misses;
+    /*! Number of released objects currently cached. */
+    uint64_t cached;
+  };
+
+  /*!
+   * @brief Creates a new slab.
+   *
+   * @param header_sz Size of the fixed part of every object.
+   * @param item_sz Size of every trailing item.
+   * @param classes Number of size classes. Class `k` holds objects with room
+   * for `2^k` items; larger requests are served without caching.
+   * @param max_cached Maximum number of released objects kept per class.
+   * @param init Callback run once on every new object, with its item
+   * capacity. Returning `ERROR_CODE` discards the object. May be `NULL`.
+   * @param fini Callback run on every object before it is freed. May be
+   * `NULL`.
+   * @param arg Additional argument passed to both callbacks.
+   * @return A pointer to the created slab, or `NULL` if creation fails.
+   */
+  [[nodiscard]]
+  struct slab *slab_create (uint64_t header_sz, uint64_t item_sz,
+                            uint32_t classes, uint32_t max_cached,
+                            int (*init) (void *obj, uint64_t capacity,
+                                         void *arg),
+                            void (*fini) (void *obj, void *arg), void *arg);
+
+  /*!
+   * @brief Takes an object with room for at least `items` items.
+   *
+   * @param slab Pointer to the slab.
+   * @param items Number of trailing items needed.
+   * @return A pointer to the object, or `NULL` if it could not be created.
+   */
+  [[nodiscard]]
+  void *slab_alloc (struct slab *slab, uint64_t items);
+
+  /*!
+   * @brief Returns the number of items an object has room for.
+   *
+   * @param obj Object returned by `slab_alloc`.
+   * @return Item capacity of the object.
+   */
+  [[nodiscard]]
+  uint64_t slab_capacity (const void *obj);
+
+  /*!
+   * @brief Releases an object back to the slab it came from.
+   *
+   * The object is cached for reuse unless it is oversize or its class is
+   * full, in which case it is finalized and freed.
+   *
+   * @param obj Object returned by `slab_alloc`. May be `NULL`.
+   */
+  void slab_free (void *obj);
+
+  /*!
+   * @brief Reads the counters of a slab.
+   *
+   * @param slab Pointer to the slab.
+   * @param stats Destination of the counters.
+   */
+  void slab_get_stats (struct slab *slab, struct slab_stats *stats);
+
+  /*!
+   * @brief Returns the argument the slab passes to its callbacks.
+   *
+   * @param slab Pointer to the slab.
+   * @return The `arg` given to `slab_create`.
+   */
+  [[nodiscard]]
+  void *slab_arg (const struct slab *slab);
+
+  /*!
+   * @brief Frees every cached object and the slab itself.
+   *
+   * Objects still in use must be released before destroying their slab.
+   *
+   * @param slab Pointer to the slab to destroy.
+   */
+  void slab_destroy (struct slab *slab);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !SLAB_H
+
+/*!
+ * @}
+ */
@@ -0,0 +1,244 @@
+#include "chunk_pool.h"
+#include "config.h" // for ERROR_CODE, SUCCESS_CODE
+
+#include <pthread.h>  // for pthread_mutex_lock, pthread_mutex_unlock
+#include <stdlib.h>   // for malloc, realloc, free
+#include <sys/mman.h> // for mmap, munmap, madvise
+#include <sys/uio.h>  // for iovec
+
+#define HUGE_PAGE_SZ (2UL * 1024 * 1024)
+#define CHUNK_ALIGN 64UL
+
+struct region
+{
+  void *base;
+  uint64_t size;
+};
+
+struct chunk_pool
+{
+  void *free;
+  struct region *regions;
+  uint32_t n_regions;
+  uint32_t per_region;
+  uint32_t flags;
+  uint64_t chunk_sz;
+  uint64_t in_use;
+  uint64_t high_water;
+  uint64_t capacity;
+  uint64_t huge_regions;
+  pthread_mutex_t mutex;
+};
+
+// map_region
+static inline void *
+map_region (struct chunk_pool *pool, uint64_t *const size)
+{
+  void *base = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (pool->flags & CHUNK_POOL_HUGETLB)
+    {
+      uint64_t huge_sz = (*size + HUGE_PAGE_SZ - 1) & ~(HUGE_PAGE_SZ - 1);
+      base = mmap (NULL, huge_sz, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (base != MAP_FAILED)
+        {
+          *size = huge_sz;
+          ++pool->huge_regions;
+          return base;
+        }
+    }
+#endif
+  base = mmap (NULL, *size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    {
+      return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+  if (pool->flags & CHUNK_POOL_HUGETLB)
+    {
+      madvise (base, *size, MADV_HUGEPAGE);
+    }
+#endif
+  return base;
+}
+
+// grow
+[[nodiscard]]
+static inline int
+grow (struct chunk_pool *pool)
+{
+  struct region *regions = (struct region *)realloc (
+      pool->regions, sizeof (struct region) * (pool->n_regions + 1));
+  if (!regions)
+    {
+      return ERROR_CODE;
+    }
+  pool->regions = regions;
+  uint64_t size = pool->chunk_sz * pool->per_region;
+  void *base = map_region (pool, &size);
+  if (!base)
+    {
+      return ERROR_CODE;
+    }
+  pool->regions[pool->n_regions].base = base;
+  pool->regions[pool->n_regions].size = size;
+  ++pool->n_regions;
+  uint64_t chunks = size / pool->chunk_sz;
+  for (uint64_t i = chunks; i > 0; --i)
+    {
+      void **chunk = (void **)((uint8_t *)base + (i - 1) * pool->chunk_sz);
+      *chunk = pool->free;
+      pool->free = chunk;
+    }
+  pool->capacity += chunks;
+  return SUCCESS_CODE;
+}
+
+// chunk_pool_create
+[[nodiscard]]
+struct chunk_pool *
+chunk_pool_create (uint64_t chunk_sz, uint32_t per_region, uint32_t flags)
+{
+  struct chunk_pool *pool
+      = (struct chunk_pool *)malloc (sizeof (struct chunk_pool));
+  if (!pool)
+    {
+      return NULL;
+    }
+  if (pthread_mutex_init (&pool->mutex, NULL))
+    {
+      free (pool);
+      return NULL;
+    }
+  chunk_sz = (chunk_sz < sizeof (void *) ? sizeof (void *) : chunk_sz);
+  pool->chunk_sz = (chunk_sz + CHUNK_ALIGN - 1) & ~(CHUNK_ALIGN - 1);
+  pool->per_region = (per_region < 1 ? 1 : per_region);
+  pool->flags = flags;
+  pool->free = NULL;
+  pool->regions = NULL;
+  pool->n_regions = 0;
+  pool->in_use = 0;
+  pool->high_water = 0;
+  pool->capacity = 0;
+  pool->huge_regions = 0;
+  return pool;
+}
+
+// chunk_pool_get
+[[nodiscard]]
+void *
+chunk_pool_get (struct chunk_pool *pool)
+{
+  pthread_mutex_lock (&pool->mutex);
+  if (!pool->free && !grow (pool))
+    {
+      pthread_mutex_unlock (&pool->mutex);
+      return NULL;
+    }
+  void **chunk = (void **)pool->free;
+  pool->free = *chunk;
+  ++pool->in_use;
+  if (pool->in_use > pool->high_water)
+    {
+      pool->high_water = pool->in_use;
+    }
+  pthread_mutex_unlock (&pool->mutex);
+  return chunk;
+}
+
+// chunk_pool_reserve
+[[nodiscard]]
+int
+chunk_pool_reserve (struct chunk_pool *pool, uint32_t regions)
+{
+  int res = SUCCESS_CODE;
+  pthread_mutex_lock (&pool->mutex);
+  while (res && pool->n_regions < regions)
+    {
+      res = grow (pool);
+    }
+  pthread_mutex_unlock (&pool->mutex);
+  return res;
+}
+
+// chunk_pool_put
+void
+chunk_pool_put (struct chunk_pool *pool, void *chunk)
+{
+  if (!chunk)
+    {
+      return;
+    }
+  pthread_mutex_lock (&pool->mutex);
+  *(void **)chunk = pool->free;
+  pool->free = chunk;
+  --pool->in_use;
+  pthread_mutex_unlock (&pool->mutex);
+}
+
+// chunk_pool_regions
+uint32_t
+chunk_pool_regions (struct chunk_pool *pool, struct iovec *iovs, uint32_t max)
+{
+  pthread_mutex_lock (&pool->mutex);
+  uint32_t n = (pool->n_regions < max ? pool->n_regions : max);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      iovs[i].iov_base = pool->regions[i].base;
+      iovs[i].iov_len = pool->regions[i].size;
+    }
+  pthread_mutex_unlock (&pool->mutex);
+  return n;
+}
+
+// chunk_pool_region_of
+int64_t
+chunk_pool_region_of (struct chunk_pool *pool, const void *chunk)
+{
+  int64_t idx = -1;
+  const uint8_t *ptr = (const uint8_t *)chunk;
+  pthread_mutex_lock (&pool->mutex);
+  for (uint32_t i = 0; i < pool->n_regions; ++i)
+    {
+      const uint8_t *base = (const uint8_t *)pool->regions[i].base;
+      if (ptr >= base && ptr < base + pool->regions[i].size)
+        {
+          idx = i;
+          break;
+        }
+    }
+  pthread_mutex_unlock (&pool->mutex);
+  return idx;
+}
+
+// chunk_pool_get_stats
+void
+chunk_pool_get_stats (struct chunk_pool *pool, struct chunk_pool_stats *stats)
+{
+  pthread_mutex_lock (&pool->mutex);
+  stats->in_use = pool->in_use;
+  stats->high_water = pool->high_water;
+  stats->capacity = pool->capacity;
+  stats->regions = pool->n_regions;
+  stats->huge_regions = pool->huge_regions;
+  pthread_mutex_unlock (&pool->mutex);
+}
+
+// chunk_pool_destroy
+void
+chunk_pool_destroy (struct chunk_pool *pool)
+{
+  if (!pool)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < pool->n_regions; ++i)
+    {
+      munmap (pool->regions[i].base, pool->regions[i].size);
+    }
+  pthread_mutex_destroy (&pool->mutex);
+  free (pool->regions);
+  free (pool);
+}
@@ -0,0 +1,194 @@
+#include "handle_table.h"
+#include "config.h" // for ERROR_CODE, SUCCESS_CODE
+
+#include <pthread.h> // for pthread_mutex_lock, pthread_mutex_unlock
+#include <stdlib.h>  // for malloc, realloc, free
+
+#define END_OF_LIST UINT32_MAX
+#define HANDLE_IDX(h) ((uint32_t)((h) & 0xFFFFFFFFUL))
+#define HANDLE_GEN(h) ((uint32_t)((h) >> 32))
+#define MAKE_HANDLE(g, i) ((((uint64_t)(g)) << 32) | (uint64_t)(i))
+
+struct slot
+{
+  void *ptr;
+  uint32_t gen;
+  uint32_t next_free;
+};
+
+struct handle_table
+{
+  struct slot *slots;
+  uint32_t capacity;
+  uint32_t free_head;
+  uint32_t size;
+  void (*release) (void *);
+  pthread_mutex_t mutex;
+};
+
+// link_free_slots
+static inline void
+link_free_slots (struct handle_table *t, const uint32_t from,
+                 const uint32_t to)
+{
+  for (uint32_t i = from; i < to; ++i)
+    {
+      t->slots[i].ptr = NULL;
+      t->slots[i].gen = 1;
+      t->slots[i].next_free = (i + 1 < to ? i + 1 : t->free_head);
+    }
+  t->free_head = from;
+}
+
+// grow
+[[nodiscard]]
+static inline int
+grow (struct handle_table *t)
+{
+  uint32_t capacity = t->capacity * 2;
+  if (capacity <= t->capacity)
+    {
+      return ERROR_CODE;
+    }
+  struct slot *slots
+      = (struct slot *)realloc (t->slots, sizeof (struct slot) * capacity);
+  if (!slots)
+    {
+      return ERROR_CODE;
+    }
+  t->slots = slots;
+  link_free_slots (t, t->capacity, capacity);
+  t->capacity = capacity;
+  return SUCCESS_CODE;
+}
+
+// handle_table_create
+[[nodiscard]]
+struct handle_table *
+handle_table_create (uint32_t capacity, void (*release) (void *))
+{
+  struct handle_table *t
+      = (struct handle_table *)malloc (sizeof (struct handle_table));
+  if (!t)
+    {
+      return NULL;
+    }
+  capacity = (capacity < 1 ? 1 : capacity);
+  t->slots = (struct slot *)malloc (sizeof (struct slot) * capacity);
+  if (!t->slots)
+    {
+      free (t);
+      return NULL;
+    }
+  if (pthread_mutex_init (&t->mutex, NULL))
+    {
+      free (t->slots);
+      free (t);
+      return NULL;
+    }
+  t->capacity = capacity;
+  t->size = 0;
+  t->release = release;
+  t->free_head = END_OF_LIST;
+  link_free_slots (t, 0, capacity);
+  return t;
+}
+
+// handle_table_insert
+[[nodiscard]]
+uint64_t
+handle_table_insert (struct handle_table *t, void *ptr)
+{
+  pthread_mutex_lock (&t->mutex);
+  if (t->free_head == END_OF_LIST && !grow (t))
+    {
+      pthread_mutex_unlock (&t->mutex);
+      return HANDLE_INVALID;
+    }
+  uint32_t idx = t->free_head;
+  struct slot *slot = &t->slots[idx];
+  t->free_head = slot->next_free;
+  slot->ptr = ptr;
+  slot->next_free = END_OF_LIST;
+  ++t->size;
+  uint64_t handle = MAKE_HANDLE (slot->gen, idx);
+  pthread_mutex_unlock (&t->mutex);
+  return handle;
+}
+
+// handle_table_get
+[[nodiscard]]
+void *
+handle_table_get (struct handle_table *t, const uint64_t handle)
+{
+  void *ptr = NULL;
+  uint32_t idx = HANDLE_IDX (handle);
+  pthread_mutex_lock (&t->mutex);
+  if (idx < t->capacity && t->slots[idx].gen == HANDLE_GEN (handle))
+    {
+      ptr = t->slots[idx].ptr;
+    }
+  pthread_mutex_unlock (&t->mutex);
+  return ptr;
+}
+
+// handle_table_delete
+int
+handle_table_delete (struct handle_table *t, const uint64_t handle)
+{
+  uint32_t idx = HANDLE_IDX (handle);
+  pthread_mutex_lock (&t->mutex);
+  if (idx >= t->capacity || t->slots[idx].gen != HANDLE_GEN (handle)
+      || !t->slots[idx].ptr)
+    {
+      pthread_mutex_unlock (&t->mutex);
+      return ERROR_CODE;
+    }
+  struct slot *slot = &t->slots[idx];
+  void *ptr = slot->ptr;
+  slot->ptr = NULL;
+  slot->gen = (slot->gen + 1 ? slot->gen + 1 : 1);
+  slot->next_free = t->free_head;
+  t->free_head = idx;
+  --t->size;
+  pthread_mutex_unlock (&t->mutex);
+  if (t->release)
+    {
+      t->release (ptr);
+    }
+  return SUCCESS_CODE;
+}
+
+// handle_table_size
+[[nodiscard]]
+uint32_t
+handle_table_size (struct handle_table *t)
+{
+  pthread_mutex_lock (&t->mutex);
+  uint32_t size = t->size;
+  pthread_mutex_unlock (&t->mutex);
+  return size;
+}
+
+// handle_table_destroy
+void
+handle_table_destroy (struct handle_table *t)
+{
+  if (!t)
+    {
+      return;
+    }
+  pthread_mutex_lock (&t->mutex);
+  for (uint32_t i = 0; i < t->capacity; ++i)
+    {
+      if (t->slots[i].ptr && t->release)
+        {
+          t->release (t->slots[i].ptr);
+        }
+      t->slots[i].ptr = NULL;
+    }
+  pthread_mutex_unlock (&t->mutex);
+  pthread_mutex_destroy (&t->mutex);
+  free (t->slots);
+  free (t);
+}
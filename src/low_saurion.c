@@ -1,16 +1,23 @@
 #include "low_saurion.h"
-#include "config.h"      // for ERROR_CODE, SUCCESS_CODE, CHUNK_SZ
-#include "linked_list.h" // for list_delete_node, list_free, list_insert
-#include "threadpool.h"  // for threadpool_add, threadpool_create
+#include "chunk_pool.h"   // for chunk_pool_get, chunk_pool_put
+#include "config.h"       // for ERROR_CODE, SUCCESS_CODE, CHUNK_SZ
+#include "handle_table.h" // for handle_table_insert, handle_table_delete
+#include "slab.h"         // for slab_alloc, slab_free, slab_create
+#include "threadpool.h"   // for threadpool_add, threadpool_create
 
+#include <asm/socket.h>                // for SO_REUSEPORT
 #include <bits/types/struct_timeval.h> // for struct timeval
-#include <liburing.h>    // for io_uring_get_sqe, io_uring, io_uring_...
-#include <netinet/in.h>  // for sockaddr_in, INADDR_ANY, in_addr
-#include <stdlib.h>      // for free, malloc
-#include <string.h>      // for memset, memcpy, strlen
-#include <sys/eventfd.h> // for eventfd, EFD_NONBLOCK
+#include <errno.h>        // for ENOBUFS
+#include <liburing.h>     // for io_uring_get_sqe, io_uring, io_uring_...
+#include <netinet/in.h>   // for sockaddr_in, INADDR_ANY, in_addr
+#include <signal.h>       // for sigaddset, sigemptyset, SIGPIPE
+#include <stdatomic.h>    // for atomic_exchange, _Atomic
+#include <stdlib.h>       // for free, malloc, calloc
+#include <string.h>       // for memset, memcpy, strlen
+#include <sys/eventfd.h>  // for eventfd, EFD_NONBLOCK
+#include <sys/mman.h>     // for munmap
+#include <sys/resource.h> // for getrlimit, RLIMIT_NOFILE
 
-struct Node;
 struct iovec;
 
 #define EV_ACC 0 //! @brief Event type for accepting a new connection.
@@ -18,6 +25,13 @@ struct iovec;
 #define EV_WRI 2 //! @brief Event type for writing data.
 #define EV_WAI 3 //! @brief Event type for waiting.
 #define EV_ERR 4 //! @brief Event type to indicate an error.
+#define EV_RCV 5 //! @brief Event type for multishot receives.
+#define EV_REL 6 //! @brief Event type for releasing a retained message.
+#define EV_SND 7 //! @brief Event type for writing a caller-owned buffer.
+#define EV_PAU 8 //! @brief Event type for pausing the reads of a connection.
+#define EV_RES 9 //! @brief Event type for resuming the reads of a connection.
+#define EV_BGT 10 //! @brief Event type for a receive budget falling under.
+#define EV_BDY 11 //! @brief Event type for reading the rest of a message.
 
 struct request
 {
@@ -28,15 +42,154 @@ struct request
   uint64_t next_offset;
   int event_type;
   uint64_t iovec_count;
+  uint64_t iovec_owned;
   int client_socket;
+  uint64_t handle;
+  int64_t buf_index;
+  uint32_t retained;
+  uint32_t streaming;
+  void *token;
+  uint64_t frame;
+  int64_t sent;
+  struct request *next;
+  struct outbound *queue;
+  struct msghdr msg;
   struct iovec iov[];
 };
 
+#define PROVIDED_BGID 0 //! @brief Buffer group of the provided buffer rings.
+
+struct provided_buffers
+{
+  struct io_uring_buf_ring *br;
+  struct slab *reqs;
+  void **bufs;
+  uint32_t *held;
+  uint32_t held_bids;
+  uint64_t chunk_sz;
+  uint32_t entries;
+  uint32_t multishot;
+};
+
+struct inbox_msg
+{
+  struct inbox_msg *next;
+  int event_type;
+  int fd;
+  void *ptr;
+  uint64_t len;
+  void *token;
+  char msg[];
+};
+
+struct inbox
+{
+  _Atomic (struct inbox_msg *) head;
+  int efd;
+  uint64_t value;
+};
+
+struct sqe_backlog
+{
+  struct io_uring_sqe *sqes;
+  uint32_t head;
+  uint32_t count;
+  uint32_t cap;
+  uint32_t resizable;
+  uint64_t sq_full;
+  uint64_t sq_deferred;
+};
+
+struct request_source
+{
+  struct chunk_pool *pool;
+  uint64_t chunk_sz;
+};
+
+struct outbound
+{
+  struct request *head;
+  struct request *tail;
+  struct iovec *iov;
+  uint64_t iov_cap;
+  uint64_t bytes;
+  int64_t done;
+  uint32_t inflight;
+  uint32_t closing;
+  uint64_t pending;
+  uint32_t over;
+};
+
+#define BACKLOG_MIN 16 //! @brief Initial capacity of a ring's SQE backlog.
+
+#define VIEW_IOV_MAX 16 //! @brief Most buffers a borrowed message may span.
+#define WRITE_IOV_MAX 1024 //! @brief Most iovecs one write takes (UIO_MAXIOV).
+
+struct saurion_lease
+{
+  uint32_t refs;
+  uint32_t sel;
+  int32_t bid;
+  struct request *req;
+  void *heap;
+  int fd;
+  uint64_t len;
+};
+
+struct view_source
+{
+  struct request *req;
+  struct saurion_lease *lease;
+  void *heap;
+  uint32_t sel;
+  int32_t bid;
+  uint8_t active;
+  int fd;
+  uint64_t len;
+};
+
+struct inbound
+{
+  struct request *recv;
+  uint64_t bytes;
+  uint32_t msgs;
+  uint32_t paused;
+  uint32_t parked;
+  uint32_t discard;
+  int park_prev;
+  int park_next;
+};
+
+#define READ_PARKED 1    //! @brief No read is posted for the connection.
+#define RECV_CANCELING 2 //! @brief Its multishot receive is being canceled.
+#define RECV_PARKED 3    //! @brief Its multishot receive is not armed.
+#define READ_STARVED 4   //! @brief Its read waits for a provided buffer.
+#define RECV_STARVED 5   //! @brief Its receive waits for a provided buffer.
+
+struct acceptor
+{
+  struct sockaddr_in addr;
+  socklen_t addr_len;
+  int multishot;
+  struct __kernel_timespec retry;
+};
+
+#define FD_RING_MAX (1U << 20) //! @brief Largest descriptor map of `fd_ring`.
+
+#define OVER_CONN 1U   //! @brief A connection is above `send_high_water`.
+#define OVER_GLOBAL 2U //! @brief The connections are above `send_global_high`.
+
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
 static struct timespec TIMEOUT_RETRY_SPEC = { 0, TIMEOUT_RETRY * 1000L };
 
+static _Thread_local const struct saurion *worker_of = NULL;
+static _Thread_local uint32_t worker_sel = 0;
+static _Thread_local uint64_t *worker_dirty = NULL;
+static _Thread_local struct view_source worker_view
+    = { NULL, NULL, NULL, 0, -1, 0, -1, 0 };
+
 struct saurion_wrapper
 {
   struct saurion *s;
@@ -47,8 +200,96 @@ struct saurion_wrapper
 static inline uint32_t
 next (struct saurion *const s)
 {
-  s->next = (s->next + 1) % s->n_threads;
-  return s->next;
+  return __atomic_add_fetch (&s->next, 1, __ATOMIC_RELAXED) % s->n_threads;
+}
+
+// fd_hash
+static inline uint32_t
+fd_hash (const int fd, const uint32_t n)
+{
+  return ((uint32_t)fd * 2654435761U) % n;
+}
+
+// pick_ring
+[[nodiscard]]
+static inline uint32_t
+pick_ring (struct saurion *const s, const int fd)
+{
+  if ((uint32_t)fd >= s->fd_ring_sz)
+    {
+      return fd_hash (fd, s->n_threads);
+    }
+  if (s->config.pick_ring)
+    {
+      return s->config.pick_ring (fd, s->conns, s->n_threads,
+                                  s->config.pick_ring_arg)
+             % s->n_threads;
+    }
+  switch (s->config.affinity)
+    {
+    case SAURION_AFFINITY_LEAST_LOADED:
+      {
+        uint32_t best = 0;
+        uint32_t least = UINT32_MAX;
+        for (uint32_t i = 0; i < s->n_threads; ++i)
+          {
+            uint32_t c = __atomic_load_n (&s->conns[i], __ATOMIC_RELAXED);
+            if (c < least)
+              {
+                least = c;
+                best = i;
+              }
+          }
+        return best;
+      }
+    case SAURION_AFFINITY_HASH:
+      return fd_hash (fd, s->n_threads);
+    default:
+      return next (s);
+    }
+}
+
+// pin_ring
+static inline void
+pin_ring (struct saurion *const s, const int fd, const uint32_t sel)
+{
+  if ((uint32_t)fd < s->fd_ring_sz)
+    {
+      __atomic_store_n (&s->fd_ring[fd], sel + 1, __ATOMIC_RELEASE);
+    }
+  __atomic_add_fetch (&s->conns[sel], 1, __ATOMIC_RELAXED);
+}
+
+// unpin_ring
+static inline void
+unpin_ring (struct saurion *const s, const int fd)
+{
+  uint32_t sel = fd_hash (fd, s->n_threads) + 1;
+  if ((uint32_t)fd < s->fd_ring_sz)
+    {
+      sel = __atomic_exchange_n (&s->fd_ring[fd], 0, __ATOMIC_ACQ_REL);
+    }
+  if (sel)
+    {
+      __atomic_sub_fetch (&s->conns[sel - 1], 1, __ATOMIC_RELAXED);
+    }
+}
+
+// ring_of
+[[nodiscard]]
+static inline uint32_t
+ring_of (struct saurion *const s, const int fd)
+{
+  if (fd < 0)
+    {
+      return next (s);
+    }
+  if ((uint32_t)fd >= s->fd_ring_sz)
+    {
+      return fd_hash (fd, s->n_threads);
+    }
+  const uint32_t sel = __atomic_load_n (&s->fd_ring[fd], __ATOMIC_ACQUIRE);
+  return (sel ? sel - 1 : next (s));
 }
 
 // htonll
@@ -81,29 +322,26 @@ ntohll (const uint64_t value)
 
 // free_request
 void
-free_request (struct request *req, void **children_ptr, const uint64_t amount)
+free_request (void *ptr)
 {
-  if (children_ptr)
-    {
-      free (children_ptr);
-      children_ptr = NULL;
-    }
-  for (uint64_t i = 0; i < amount; ++i)
-    {
-      free (req->iov[i].iov_base);
-      req->iov[i].iov_base = NULL;
-    }
-  free (req);
-  req = NULL;
-  free (children_ptr);
-  children_ptr = NULL;
+  slab_free (ptr);
+}
+
+// iovec_len
+static inline uint64_t
+iovec_len (const uint64_t amount, const uint64_t pos, const uint64_t size,
+           const uint64_t chunk_sz)
+{
+  uint64_t len = (pos == (amount - 1) ? (size % chunk_sz) : chunk_sz);
+  return (len == 0 ? chunk_sz : len);
 }
 
 // initialize_iovec
 [[nodiscard]]
 int
 initialize_iovec (struct iovec *iov, const uint64_t amount, const uint64_t pos,
-                  const void *msg, const uint64_t size, const uint8_t h)
+                  const void *msg, const uint64_t size,
+                  const uint64_t chunk_sz, const uint8_t h)
 {
   if (!iov || !iov->iov_base)
     {
@@ -113,7 +351,7 @@ initialize_iovec (struct iovec *iov, const uint64_t amount, const uint64_t pos,
     {
       uint64_t len = iov->iov_len;
       char *dest = (char *)iov->iov_base;
-      char *orig = (char *)msg + pos * CHUNK_SZ;
+      char *orig = (char *)msg + pos * chunk_sz;
       uint64_t cpy_sz = 0;
       if (h)
         {
@@ -138,12 +376,12 @@ initialize_iovec (struct iovec *iov, const uint64_t amount, const uint64_t pos,
       cpy_sz = (len < size ? len : size);
       memcpy (dest, orig, cpy_sz);
       dest += cpy_sz;
-      uint64_t rem = CHUNK_SZ - (dest - (char *)iov->iov_base);
+      uint64_t rem = chunk_sz - (dest - (char *)iov->iov_base);
       memset (dest, 0, rem);
     }
   else
     {
-      memset ((char *)iov->iov_base, 0, CHUNK_SZ);
+      memset ((char *)iov->iov_base, 0, chunk_sz);
     }
   return SUCCESS_CODE;
 }
@@ -152,45 +390,303 @@ initialize_iovec (struct iovec *iov, const uint64_t amount, const uint64_t pos,
 [[nodiscard]]
 int
 allocate_iovec (struct iovec *iov, const uint64_t amount, const uint64_t pos,
-                const uint64_t size, void **chd_ptr)
+                const uint64_t size, const uint64_t chunk_sz, void **chd_ptr)
 {
-  if (!iov || !chd_ptr)
+  if (!iov)
     {
       return ERROR_CODE;
     }
-  iov->iov_base = malloc (CHUNK_SZ);
+  iov->iov_base = malloc (chunk_sz);
   if (!iov->iov_base)
     {
       return ERROR_CODE;
     }
-  iov->iov_len = (pos == (amount - 1) ? (size % CHUNK_SZ) : CHUNK_SZ);
-  if (iov->iov_len == 0)
+  iov->iov_len = iovec_len (amount, pos, size, chunk_sz);
+  if (chd_ptr)
+    {
+      chd_ptr[pos] = iov->iov_base;
+    }
+  return SUCCESS_CODE;
+}
+
+// request_fini
+static void
+request_fini (void *obj, void *arg)
+{
+  struct chunk_pool *pool = ((struct request_source *)arg)->pool;
+  struct request *req = (struct request *)obj;
+  for (uint64_t i = 0; i < req->iovec_owned; ++i)
+    {
+      if (pool)
+        {
+          chunk_pool_put (pool, req->iov[i].iov_base);
+        }
+      else
+        {
+          free (req->iov[i].iov_base);
+        }
+      req->iov[i].iov_base = NULL;
+    }
+  req->iovec_owned = 0;
+}
+
+// request_init
+[[nodiscard]]
+static int
+request_init (void *obj, uint64_t capacity, void *arg)
+{
+  const struct request_source *const src = (struct request_source *)arg;
+  struct chunk_pool *pool = src->pool;
+  struct request *req = (struct request *)obj;
+  req->iovec_owned = 0;
+  req->buf_index = -1;
+  for (uint64_t i = 0; i < capacity; ++i)
+    {
+      int res = ERROR_CODE;
+      if (pool)
+        {
+          req->iov[i].iov_base = chunk_pool_get (pool);
+          req->iov[i].iov_len = src->chunk_sz;
+          res = (req->iov[i].iov_base ? SUCCESS_CODE : ERROR_CODE);
+        }
+      else
+        {
+          res = allocate_iovec (&req->iov[i], capacity, i,
+                                capacity * src->chunk_sz, src->chunk_sz, NULL);
+        }
+      if (!res)
+        {
+          request_fini (req, arg);
+          return ERROR_CODE;
+        }
+      ++req->iovec_owned;
+    }
+  if (pool && capacity == 1)
+    {
+      req->buf_index = chunk_pool_region_of (pool, req->iov[0].iov_base);
+    }
+  return SUCCESS_CODE;
+}
+
+// request_slab_create
+[[nodiscard]]
+struct slab *
+request_slab_create (struct chunk_pool *pool, const uint64_t chunk_sz)
+{
+  struct request_source *src
+      = (struct request_source *)malloc (sizeof (struct request_source));
+  if (!src)
+    {
+      return NULL;
+    }
+  src->pool = pool;
+  src->chunk_sz = chunk_sz;
+  struct slab *slab = slab_create (sizeof (struct request),
+                                   sizeof (struct iovec), SLAB_CLASSES,
+                                   SLAB_CACHE, request_init, request_fini, src);
+  if (!slab)
     {
-      iov->iov_len = CHUNK_SZ;
+      free (src);
     }
-  chd_ptr[pos] = iov->iov_base;
+  return slab;
+}
+
+// request_slab_destroy
+void
+request_slab_destroy (struct slab *slab)
+{
+  if (!slab)
+    {
+      return;
+    }
+  void *src = slab_arg (slab);
+  slab_destroy (slab);
+  free (src);
+}
+
+// bare_request_init
+[[nodiscard]]
+static int
+bare_request_init (void *obj, uint64_t capacity, void *arg)
+{
+  (void)capacity;
+  (void)arg;
+  struct request *req = (struct request *)obj;
+  req->iovec_owned = 0;
+  req->buf_index = -1;
+  req->iov[0].iov_base = NULL;
+  req->iov[0].iov_len = 0;
   return SUCCESS_CODE;
 }
 
+// send_slab_create
+[[nodiscard]]
+static struct slab *
+send_slab_create (void)
+{
+  // The two extra iovecs in the header make room for the frame around the
+  // caller's payload: length, payload and footer. Reads of the rest of a
+  // message use the first one alone.
+  return slab_create (sizeof (struct request) + 2 * sizeof (struct iovec),
+                      sizeof (struct iovec), 1, SLAB_CACHE, bare_request_init,
+                      NULL, NULL);
+}
+
+// copy_slab_create
+[[nodiscard]]
+static struct slab *
+copy_slab_create (const uint64_t chunk_sz)
+{
+  // Byte-sized items, in classes up to a whole chunk: the copy of any
+  // message that fits in a read, or any message posted to the ring's inbox.
+  uint32_t classes = 1;
+  while (((uint64_t)1 << (classes - 1)) < chunk_sz)
+    {
+      ++classes;
+    }
+  return slab_create (0, 1, classes, SLAB_CACHE, NULL, NULL, NULL);
+}
+
+// copy_alloc
+[[nodiscard]]
+static inline void *
+copy_alloc (struct slab *const copies, const uint64_t size)
+{
+  if (!copies)
+    {
+      return malloc (size);
+    }
+  // Sizes this large only come from corrupt headers.
+  return (size < UINT64_MAX / 2 ? slab_alloc (copies, size) : NULL);
+}
+
+// copy_free
+static inline void
+copy_free (const struct slab *const copies, void *const ptr)
+{
+  if (copies)
+    {
+      slab_free (ptr);
+      return;
+    }
+  free (ptr);
+}
+
+// provided_destroy
+static void
+provided_destroy (struct io_uring *const ring, struct chunk_pool *const pool,
+                  struct provided_buffers *const pb)
+{
+  if (!pb)
+    {
+      return;
+    }
+  // Single issuer rings only accept the unregistration from their worker;
+  // the kernel drops the ring with the io_uring instance, so just unmap it.
+  if (pb->br
+      && io_uring_free_buf_ring (ring, pb->br, pb->entries, PROVIDED_BGID))
+    {
+      munmap (pb->br, pb->entries * sizeof (struct io_uring_buf));
+    }
+  for (uint32_t i = 0; pb->bufs && i < pb->entries; ++i)
+    {
+      chunk_pool_put (pool, pb->bufs[i]);
+    }
+  slab_destroy (pb->reqs);
+  free (pb->held);
+  free (pb->bufs);
+  free (pb);
+}
+
+// provided_create
+[[nodiscard]]
+static struct provided_buffers *
+provided_create (struct io_uring *const ring, struct chunk_pool *const pool,
+                 const uint32_t entries, const uint32_t multishot,
+                 const uint64_t chunk_sz)
+{
+  if (entries == 0)
+    {
+      return NULL;
+    }
+  struct provided_buffers *pb
+      = (struct provided_buffers *)malloc (sizeof (struct provided_buffers));
+  if (!pb)
+    {
+      return NULL;
+    }
+  pb->entries = entries;
+  pb->chunk_sz = chunk_sz;
+  pb->multishot = multishot;
+  pb->br = NULL;
+  pb->bufs = (void **)calloc (pb->entries, sizeof (void *));
+  pb->held = (uint32_t *)calloc (pb->entries, sizeof (uint32_t));
+  pb->held_bids = 0;
+  pb->reqs = slab_create (sizeof (struct request), sizeof (struct iovec), 1,
+                          SLAB_CACHE, bare_request_init, NULL, NULL);
+  int ret = 0;
+  if (pb->bufs && pb->held && pb->reqs)
+    {
+      pb->br = io_uring_setup_buf_ring (ring, pb->entries, PROVIDED_BGID, 0,
+                                        &ret);
+    }
+  if (!pb->br)
+    {
+      provided_destroy (ring, pool, pb);
+      return NULL;
+    }
+  int mask = io_uring_buf_ring_mask (pb->entries);
+  for (uint32_t i = 0; i < pb->entries; ++i)
+    {
+      pb->bufs[i] = chunk_pool_get (pool);
+      if (!pb->bufs[i])
+        {
+          provided_destroy (ring, pool, pb);
+          return NULL;
+        }
+      io_uring_buf_ring_add (pb->br, pb->bufs[i], (unsigned)pb->chunk_sz,
+                             (uint16_t)i, mask, (int)i);
+    }
+  io_uring_buf_ring_advance (pb->br, (int)pb->entries);
+  return pb;
+}
+
+// provided_attach
+static inline void
+provided_attach (struct provided_buffers *const pb, struct request *const req,
+                 const uint16_t bid, const int len)
+{
+  req->iov[0].iov_base = pb->bufs[bid];
+  req->iov[0].iov_len = (uint64_t)len;
+  req->iovec_count = 1;
+  if ((uint64_t)len < pb->chunk_sz)
+    {
+      ((uint8_t *)pb->bufs[bid])[len] = 0;
+    }
+}
+
 // set_request
 [[nodiscard]]
 int
-set_request (struct request **r, struct Node **l, uint64_t s, const void *m,
-             uint8_t h)
+set_request (struct request **r, struct slab *p, struct handle_table *t,
+             uint64_t s, uint64_t c, const void *m, uint8_t h)
 {
   uint64_t full_size = s;
   if (h)
     {
       full_size += (sizeof (uint64_t) + sizeof (uint8_t));
     }
-  uint64_t amount = full_size / CHUNK_SZ;
-  amount = amount + (full_size % CHUNK_SZ == 0 ? 0 : 1);
-  struct request *temp = (struct request *)malloc (
-      sizeof (struct request) + sizeof (struct iovec) * amount);
+  uint64_t amount = full_size / c;
+  amount = amount + (full_size % c == 0 ? 0 : 1);
+  struct request *temp = (struct request *)slab_alloc (p, amount);
   if (!temp)
     {
       return ERROR_CODE;
     }
+  temp->retained = 0;
+  temp->sent = 0;
+  temp->next = NULL;
+  temp->queue = NULL;
   if (!*r)
     {
       *r = temp;
@@ -199,6 +695,7 @@ set_request (struct request **r, struct Node **l, uint64_t s, const void *m,
       (*r)->prev_remain = 0;
       (*r)->next_iov = 0;
       (*r)->next_offset = 0;
+      (*r)->streaming = 0;
     }
   else
     {
@@ -209,168 +706,1215 @@ set_request (struct request **r, struct Node **l, uint64_t s, const void *m,
       temp->prev_remain = (*r)->prev_remain;
       temp->next_iov = (*r)->next_iov;
       temp->next_offset = (*r)->next_offset;
+      temp->streaming = (*r)->streaming;
       *r = temp;
     }
   struct request *req = *r;
-  req->iovec_count = (int)amount;
-  void **children_ptr = (void **)malloc (amount * sizeof (void *));
-  if (!children_ptr)
-    {
-      free_request (req, children_ptr, 0);
-      return ERROR_CODE;
-    }
+  req->iovec_count = amount;
   for (uint64_t i = 0; i < amount; ++i)
     {
-      if (!allocate_iovec (&req->iov[i], amount, i, full_size, children_ptr))
-        {
-          free_request (req, children_ptr, amount);
-          return ERROR_CODE;
-        }
-      if (!initialize_iovec (&req->iov[i], amount, i, m, s, h))
+      req->iov[i].iov_len = iovec_len (amount, i, full_size, c);
+      if (!initialize_iovec (&req->iov[i], amount, i, m, s, c, h))
         {
-          free_request (req, children_ptr, amount);
+          free_request (req);
           return ERROR_CODE;
         }
     }
-  if (!list_insert (l, req, amount, children_ptr))
+  req->handle = handle_table_insert (t, req);
+  if (req->handle == HANDLE_INVALID)
     {
-      free_request (req, children_ptr, amount);
+      free_request (req);
       return ERROR_CODE;
     }
-  free (children_ptr);
   return SUCCESS_CODE;
 }
 
-/******************* ADDERS *******************/
-// add_accept
+// is_fixed
+static inline int
+is_fixed (const struct saurion *const s, const struct request *const req,
+          const int sel)
+{
+  return req->iovec_count == 1 && req->buf_index >= 0
+         && (uint64_t)req->buf_index < s->fixed[sel];
+}
+
+// prep_read
 static inline void
-add_accept (struct saurion *const s, struct sockaddr_in *const ca,
-            socklen_t *const cal)
+prep_read (const struct saurion *const s, struct io_uring_sqe *const sqe,
+           struct request *const req, const int sel)
 {
-  int res = ERROR_CODE;
-  pthread_mutex_lock (&s->m_rings[0]);
-  while (res != SUCCESS_CODE)
+  if (req->event_type == EV_RCV)
     {
-      struct io_uring_sqe *sqe = io_uring_get_sqe (&s->rings[0]);
-      while (!sqe)
-        {
-          sqe = io_uring_get_sqe (&s->rings[0]);
-          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
-        }
-      struct request *req = NULL;
-      if (!set_request (&req, &s->list, 0, NULL, 0))
-        {
-          free (sqe);
-          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
-          res = ERROR_CODE;
-          continue;
-        }
-      req->client_socket = 0;
-      req->event_type = EV_ACC;
-      io_uring_prep_accept (sqe, s->ss, (struct sockaddr *const)ca, cal, 0);
-      io_uring_sqe_set_data (sqe, req);
-      if (io_uring_submit (&s->rings[0]) < 0)
-        {
-          free (sqe);
-          list_delete_node (&s->list, req);
-          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
-          res = ERROR_CODE;
-          continue;
-        }
-      res = SUCCESS_CODE;
+      io_uring_prep_recv_multishot (sqe, req->client_socket, NULL, 0, 0);
+      io_uring_sqe_set_flags (sqe, IOSQE_BUFFER_SELECT);
+      sqe->buf_group = PROVIDED_BGID;
+      return;
+    }
+  if (req->iovec_count == 0)
+    {
+      io_uring_prep_read (sqe, req->client_socket, NULL,
+                          (unsigned)s->config.chunk_sz, 0);
+      io_uring_sqe_set_flags (sqe, IOSQE_BUFFER_SELECT);
+      sqe->buf_group = PROVIDED_BGID;
+      return;
+    }
+  if (is_fixed (s, req, sel))
+    {
+      io_uring_prep_read_fixed (sqe, req->client_socket, req->iov[0].iov_base,
+                                req->iov[0].iov_len, 0, (int)req->buf_index);
+      return;
     }
-  pthread_mutex_unlock (&s->m_rings[0]);
+  io_uring_prep_readv (sqe, req->client_socket, &req->iov[0], req->iovec_count,
+                       0);
 }
 
-// add_fd
-static inline void
-add_fd (struct saurion *const s, const int client_socket, const int sel)
+// request_bytes
+static inline uint64_t
+request_bytes (const struct request *const req)
 {
-  int res = ERROR_CODE;
-  pthread_mutex_lock (&s->m_rings[sel]);
-  while (res != SUCCESS_CODE)
+  uint64_t bytes = 0;
+  for (uint64_t i = 0; i < req->iovec_count; ++i)
     {
-      struct io_uring *ring = &s->rings[sel];
-      struct io_uring_sqe *sqe = io_uring_get_sqe (ring);
-      while (!sqe)
-        {
-          sqe = io_uring_get_sqe (ring);
-          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
-        }
-      struct request *req = NULL;
-      if (!set_request (&req, &s->list, CHUNK_SZ, NULL, 0))
-        {
-          free (sqe);
-          res = ERROR_CODE;
-          continue;
-        }
-      req->event_type = EV_REA;
-      req->client_socket = client_socket;
-      io_uring_prep_readv (sqe, client_socket, &req->iov[0], req->iovec_count,
-                           0);
-      io_uring_sqe_set_data (sqe, req);
-      if (io_uring_submit (ring) < 0)
-        {
-          free (sqe);
-          list_delete_node (&s->list, req);
-          res = ERROR_CODE;
-          continue;
-        }
-      res = SUCCESS_CODE;
+      bytes += req->iov[i].iov_len;
     }
-  pthread_mutex_unlock (&s->m_rings[sel]);
+  return bytes;
 }
 
-// add_efd
+// request_resume
 static inline void
-add_efd (struct saurion *const s, const int client_socket, const int sel)
+request_resume (const struct request *const req, uint64_t *const pos,
+                uint64_t *const off)
 {
-  add_fd (s, client_socket, sel);
+  // Skip the bytes that previous short writes already sent.
+  *pos = 0;
+  *off = (uint64_t)req->sent;
+  while (*off && *off >= req->iov[*pos].iov_len)
+    {
+      *off -= req->iov[*pos].iov_len;
+      ++*pos;
+    }
 }
 
-// add_read
+// request_trim
 static inline void
-add_read (struct saurion *const s, const int client_socket)
+request_trim (struct request *const req, uint64_t len)
 {
-  int sel = next (s);
-  add_fd (s, client_socket, sel);
+  // Only the bytes received count, the rest of the buffers is stale.
+  uint64_t i = 0;
+  for (; i < req->iovec_count && len; ++i)
+    {
+      req->iov[i].iov_len = MIN (req->iov[i].iov_len, len);
+      len -= req->iov[i].iov_len;
+    }
+  req->iovec_count = i;
 }
 
-// add_read_continue
+// prep_write
 static inline void
-add_read_continue (struct saurion *const s, struct request *oreq,
-                   const int sel)
+prep_write (const struct saurion *const s, struct io_uring_sqe *const sqe,
+            struct request *const req, const int sel)
 {
-  pthread_mutex_lock (&s->m_rings[sel]);
-  int res = ERROR_CODE;
-  while (res != SUCCESS_CODE)
+  uint64_t pos = 0;
+  uint64_t off = 0;
+  request_resume (req, &pos, &off);
+  if (is_fixed (s, req, sel))
+    {
+      io_uring_prep_write_fixed (
+          sqe, req->client_socket, (uint8_t *)req->iov[0].iov_base + off,
+          (unsigned)(req->iov[0].iov_len - off), 0, (int)req->buf_index);
+      return;
+    }
+  if (off)
+    {
+      io_uring_prep_write (sqe, req->client_socket,
+                           (uint8_t *)req->iov[pos].iov_base + off,
+                           (unsigned)(req->iov[pos].iov_len - off), 0);
+      return;
+    }
+  uint64_t count = req->iovec_count - pos;
+  count = (count > WRITE_IOV_MAX ? WRITE_IOV_MAX : count);
+  if (s->config.zc_threshold
+      && request_bytes (req) - (uint64_t)req->sent >= s->config.zc_threshold)
+    {
+      // The header lives in the request, so it stays valid until SQPOLL
+      // rings pick the operation up.
+      memset (&req->msg, 0, sizeof (req->msg));
+      req->msg.msg_iov = &req->iov[pos];
+      req->msg.msg_iovlen = count;
+      io_uring_prep_sendmsg_zc (sqe, req->client_socket, &req->msg, 0);
+      sqe->ioprio |= IORING_SEND_ZC_REPORT_USAGE;
+      return;
+    }
+  io_uring_prep_writev (sqe, req->client_socket, &req->iov[pos],
+                        (unsigned)count, 0);
+}
+
+/******************* ADDERS *******************/
+// ring_lock
+static inline void
+ring_lock (struct saurion *const s, const uint32_t sel)
+{
+  if (!s->config.single_issuer)
+    {
+      pthread_mutex_lock (&s->m_rings[sel]);
+    }
+}
+
+// ring_unlock
+static inline void
+ring_unlock (struct saurion *const s, const uint32_t sel)
+{
+  if (!s->config.single_issuer)
+    {
+      pthread_mutex_unlock (&s->m_rings[sel]);
+    }
+}
+
+// backlog_move
+static inline uint32_t
+backlog_move (struct io_uring *const ring, struct sqe_backlog *const bl)
+{
+  uint32_t moved = 0;
+  while (bl->count)
     {
-      struct io_uring *ring = &s->rings[sel];
       struct io_uring_sqe *sqe = io_uring_get_sqe (ring);
-      while (!sqe)
+      if (!sqe)
         {
-          sqe = io_uring_get_sqe (ring);
-          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+          break;
+        }
+      memcpy (sqe, &bl->sqes[bl->head], sizeof (struct io_uring_sqe));
+      ++bl->head;
+      --bl->count;
+      ++moved;
+    }
+  if (!bl->count)
+    {
+      bl->head = 0;
+    }
+  return moved;
+}
+
+// backlog_push
+[[nodiscard]]
+static inline struct io_uring_sqe *
+backlog_push (struct sqe_backlog *const bl)
+{
+  if (bl->head + bl->count == bl->cap)
+    {
+      if (bl->head)
+        {
+          memmove (bl->sqes, bl->sqes + bl->head,
+                   bl->count * sizeof (struct io_uring_sqe));
+          bl->head = 0;
         }
-      if (!set_request (&oreq, &s->list, oreq->prev_remain, NULL, 0))
+      else
         {
-          free (sqe);
-          res = ERROR_CODE;
-          continue;
+          const uint32_t cap = (bl->cap ? bl->cap * 2 : BACKLOG_MIN);
+          struct io_uring_sqe *sqes = (struct io_uring_sqe *)realloc (
+              bl->sqes, cap * sizeof (struct io_uring_sqe));
+          if (!sqes)
+            {
+              return NULL;
+            }
+          bl->sqes = sqes;
+          bl->cap = cap;
         }
-      io_uring_prep_readv (sqe, oreq->client_socket, &oreq->iov[0],
-                           oreq->iovec_count, 0);
-      io_uring_sqe_set_data (sqe, oreq);
-      if (io_uring_submit (ring) < 0)
+    }
+  struct io_uring_sqe *sqe = &bl->sqes[bl->head + bl->count];
+  ++bl->count;
+  memset (sqe, 0, sizeof (struct io_uring_sqe));
+  return sqe;
+}
+
+// get_sqe
+static inline struct io_uring_sqe *
+get_sqe (struct saurion *const s, const uint32_t sel)
+{
+  struct io_uring *const ring = &s->rings[sel];
+  struct sqe_backlog *const bl = &s->backlogs[sel];
+  if (worker_of == s && worker_dirty && sel != worker_sel)
+    {
+      // Submitted by this worker's next worker_flush.
+      worker_dirty[sel / 64] |= 1ULL << (sel % 64);
+    }
+  if (bl->count)
+    {
+      backlog_move (ring, bl);
+    }
+  // Operations already waiting go first, so a connection's writes keep
+  // their order.
+  struct io_uring_sqe *sqe = (bl->count ? NULL : io_uring_get_sqe (ring));
+  if (sqe)
+    {
+      return sqe;
+    }
+  ++bl->sq_full;
+  if (!bl->count)
+    {
+      io_uring_submit (ring);
+      sqe = io_uring_get_sqe (ring);
+      if (sqe)
         {
-          free (sqe);
-          list_delete_node (&s->list, oreq);
-          res = ERROR_CODE;
-          continue;
+          return sqe;
         }
-      res = SUCCESS_CODE;
     }
+  // The SQ is still full: prepare the operation in the backlog instead of
+  // waiting for the kernel with the ring locked. flush_ring moves it to the
+  // SQ once there is room.
+  ++bl->sq_deferred;
+  while (!(sqe = backlog_push (bl)))
+    {
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  return sqe;
+}
+
+// grow_ring
+[[nodiscard]]
+static inline int
+grow_ring (struct saurion *const s, const uint32_t sel)
+{
+  struct sqe_backlog *const bl = &s->backlogs[sel];
+  struct io_uring *const ring = &s->rings[sel];
+  if (!bl->count || !bl->resizable
+      || ring->sq.ring_entries >= s->config.max_ring_entries)
+    {
+      return ERROR_CODE;
+    }
+#ifdef IO_URING_CHECK_VERSION
+#if !IO_URING_CHECK_VERSION(2, 9)
+  struct io_uring_params p;
+  memset (&p, 0, sizeof (p));
+  p.sq_entries = MIN (ring->sq.ring_entries * 2, s->config.max_ring_entries);
+  p.cq_entries = MAX (ring->cq.ring_entries, p.sq_entries * 2);
+  p.flags = IORING_SETUP_CQSIZE;
+  if (!io_uring_resize_rings (ring, &p))
+    {
+      return SUCCESS_CODE;
+    }
+#endif
+#endif
+  // Either liburing cannot resize or the kernel refused (older kernels, or
+  // rings without IORING_SETUP_DEFER_TASKRUN); keep the current size.
+  bl->resizable = 0;
+  return ERROR_CODE;
+}
+
+// flush_ring
+static inline void
+flush_ring (struct saurion *const s, const uint32_t sel)
+{
+  ring_lock (s, sel);
+  struct io_uring *const ring = &s->rings[sel];
+  while (1)
+    {
+      if (io_uring_sq_ready (ring))
+        {
+          // With SQPOLL this only publishes the tail, entering the kernel
+          // just when the submission thread went idle
+          // (IORING_SQ_NEED_WAKEUP).
+          io_uring_submit (ring);
+        }
+      if (!backlog_move (ring, &s->backlogs[sel]) && !grow_ring (s, sel))
+        {
+          break;
+        }
+    }
+  ring_unlock (s, sel);
+}
+
+// worker_flush
+static inline void
+worker_flush (struct saurion *const s)
+{
+  flush_ring (s, worker_sel);
+  if (!worker_dirty)
+    {
+      // Without its mask the worker cannot tell which rings it used.
+      for (uint32_t i = 0; i < s->n_threads; ++i)
+        {
+          if (i != worker_sel)
+            {
+              flush_ring (s, i);
+            }
+        }
+      return;
+    }
+  for (uint32_t w = 0; w < (s->n_threads + 63) / 64; ++w)
+    {
+      while (worker_dirty[w])
+        {
+          const uint32_t bit = (uint32_t)__builtin_ctzll (worker_dirty[w]);
+          worker_dirty[w] &= worker_dirty[w] - 1;
+          flush_ring (s, w * 64 + bit);
+        }
+    }
+}
+
+// add_accept
+static inline void
+add_accept (struct saurion *const s, const uint32_t sel,
+            struct sockaddr_in *const ca, socklen_t *const cal,
+            const int multishot)
+{
+  ring_lock (s, sel);
+  struct request *req = NULL;
+  while (!set_request (&req, s->slabs[sel], s->tables[sel], 0,
+                       s->config.chunk_sz, NULL, 0))
+    {
+      req = NULL;
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  req->client_socket = 0;
+  req->event_type = EV_ACC;
+  const int ls = (s->listeners ? s->listeners[sel] : s->ss);
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  if (multishot)
+    {
+      io_uring_prep_multishot_accept (sqe, ls, (struct sockaddr *const)ca,
+                                      cal, 0);
+    }
+  else
+    {
+      io_uring_prep_accept (sqe, ls, (struct sockaddr *const)ca, cal, 0);
+    }
+  io_uring_sqe_set_data (sqe, req);
+  ring_unlock (s, sel);
+}
+
+// add_accept_retry
+static inline void
+add_accept_retry (struct saurion *const s, const uint32_t sel,
+                  struct acceptor *const acc)
+{
+  ring_lock (s, sel);
+  struct request *req = NULL;
+  while (!set_request (&req, s->slabs[sel], s->tables[sel], 0,
+                       s->config.chunk_sz, NULL, 0))
+    {
+      req = NULL;
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  req->client_socket = 0;
+  req->event_type = EV_ACC;
+  acc->retry.tv_sec = ACCEPT_RETRY / 1000L;
+  acc->retry.tv_nsec = (ACCEPT_RETRY % 1000L) * 1000000L;
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  io_uring_prep_timeout (sqe, &acc->retry, 0, 0);
+  io_uring_sqe_set_data (sqe, req);
+  ring_unlock (s, sel);
+}
+
+// inbound_of
+[[nodiscard]]
+static inline struct inbound *
+inbound_of (struct saurion *const s, const int fd, const uint32_t sel)
+{
+  // Like the outbound queues, only the worker of the ring a connection is
+  // pinned to reads from it.
+  if (fd < 0 || (uint32_t)fd >= s->fd_ring_sz
+      || __atomic_load_n (&s->fd_ring[fd], __ATOMIC_ACQUIRE) != sel + 1)
+    {
+      return NULL;
+    }
+  return &s->inbound[fd];
+}
+
+// record_recv_arm
+static inline void
+record_recv_arm (struct saurion *const s, const int sel)
+{
+  pthread_mutex_lock (&s->m_rings[sel]);
+  ++s->stats[sel].recv_arms;
+  pthread_mutex_unlock (&s->m_rings[sel]);
+}
+
+// add_fd
+static inline void
+add_fd (struct saurion *const s, const int client_socket, const int sel)
+{
+  ring_lock (s, sel);
+  struct request *req = NULL;
+  struct provided_buffers *pb = s->provided[sel];
+  const uint64_t chunk_sz = s->config.chunk_sz;
+  while (!set_request (&req, pb ? pb->reqs : s->slabs[sel], s->tables[sel],
+                       pb ? 0 : chunk_sz, chunk_sz, NULL, 0))
+    {
+      req = NULL;
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  req->event_type = EV_REA;
+  if (pb && pb->multishot && client_socket != s->efds[sel])
+    {
+      req->event_type = EV_RCV;
+    }
+  req->client_socket = client_socket;
+  const int multishot = (req->event_type == EV_RCV);
+  struct inbound *const in = inbound_of (s, client_socket, sel);
+  if (in)
+    {
+      in->recv = (multishot ? req : NULL);
+    }
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  prep_read (s, sqe, req, sel);
+  io_uring_sqe_set_data (sqe, req);
+  ring_unlock (s, sel);
+  if (multishot)
+    {
+      record_recv_arm (s, sel);
+    }
+}
+
+// add_recv
+static inline void
+add_recv (struct saurion *const s, struct request *const req, const int sel)
+{
+  ring_lock (s, sel);
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  prep_read (s, sqe, req, sel);
+  io_uring_sqe_set_data (sqe, req);
+  ring_unlock (s, sel);
+  record_recv_arm (s, sel);
+}
+
+// add_efd
+static inline void
+add_efd (struct saurion *const s, const int client_socket, const int sel)
+{
+  add_fd (s, client_socket, sel);
+}
+
+// owns_ring
+static inline int
+owns_ring (const struct saurion *const s, const uint32_t sel)
+{
+  return worker_of == s && worker_sel == sel;
+}
+
+// inbox_push
+static inline void
+inbox_push (struct saurion *const s, const uint32_t sel,
+            struct inbox_msg *const m)
+{
+  struct inbox *const ib = &s->inboxes[sel];
+  struct inbox_msg *head = atomic_load_explicit (&ib->head,
+                                                 memory_order_relaxed);
+  do
+    {
+      m->next = head;
+    }
+  while (!atomic_compare_exchange_weak_explicit (
+      &ib->head, &head, m, memory_order_release, memory_order_relaxed));
+  // The owner takes the whole stack per wakeup, so only the message that
+  // finds it empty needs to signal it.
+  uint64_t u = 1;
+  while (!head && write (ib->efd, &u, sizeof (u)) < 0)
+    {
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+}
+
+// inbox_post
+static inline void
+inbox_post (struct saurion *const s, const uint32_t sel, const int event_type,
+            const int fd, const char *const msg)
+{
+  const uint64_t len = (msg ? strlen (msg) + 1 : 0);
+  struct inbox_msg *m = NULL;
+  while (!(m = (struct inbox_msg *)slab_alloc (
+               s->copies[sel], sizeof (struct inbox_msg) + len)))
+    {
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  m->next = NULL;
+  m->event_type = event_type;
+  m->fd = fd;
+  m->ptr = NULL;
+  m->len = 0;
+  m->token = NULL;
+  if (msg)
+    {
+      memcpy (m->msg, msg, len);
+    }
+  inbox_push (s, sel, m);
+}
+
+// add_read
+static inline void
+add_read (struct saurion *const s, const int client_socket)
+{
+  const uint32_t sel = ring_of (s, client_socket);
+  if (s->config.single_issuer && !owns_ring (s, sel))
+    {
+      inbox_post (s, sel, EV_REA, client_socket, NULL);
+      return;
+    }
+  add_fd (s, client_socket, sel);
+}
+
+// read_limited
+static inline int
+read_limited (const struct saurion *const s)
+{
+  return s->config.read_max_msgs || s->config.read_max_bytes
+         || s->config.read_global_msgs || s->config.read_global_bytes;
+}
+
+// read_blocked
+[[nodiscard]]
+static inline int
+read_blocked (const struct saurion *const s, const struct inbound *const in)
+{
+  const struct saurion_config *const c = &s->config;
+  return in->paused
+         || (c->read_max_msgs
+             && __atomic_load_n (&in->msgs, __ATOMIC_SEQ_CST)
+                    >= c->read_max_msgs)
+         || (c->read_max_bytes
+             && __atomic_load_n (&in->bytes, __ATOMIC_SEQ_CST)
+                    >= c->read_max_bytes)
+         || (c->read_global_msgs
+             && __atomic_load_n (&s->held_msgs, __ATOMIC_SEQ_CST)
+                    >= c->read_global_msgs)
+         || (c->read_global_bytes
+             && __atomic_load_n (&s->held_bytes, __ATOMIC_SEQ_CST)
+                    >= c->read_global_bytes);
+}
+
+// park_list
+[[nodiscard]]
+static inline int *
+park_list (struct saurion *const s, const struct inbound *const in,
+           const uint32_t sel)
+{
+  return (in->parked >= READ_STARVED ? &s->starved[sel] : &s->parked[sel]);
+}
+
+// park_link
+static inline void
+park_link (struct saurion *const s, const int fd, int *const head)
+{
+  struct inbound *const in = &s->inbound[fd];
+  in->park_prev = -1;
+  in->park_next = *head;
+  if (in->park_next >= 0)
+    {
+      s->inbound[in->park_next].park_prev = fd;
+    }
+  *head = fd;
+}
+
+// park_unlink
+static inline void
+park_unlink (struct saurion *const s, const int fd, int *const head)
+{
+  const struct inbound *const in = &s->inbound[fd];
+  if (in->park_prev >= 0)
+    {
+      s->inbound[in->park_prev].park_next = in->park_next;
+    }
+  else
+    {
+      *head = in->park_next;
+    }
+  if (in->park_next >= 0)
+    {
+      s->inbound[in->park_next].park_prev = in->park_prev;
+    }
+}
+
+// read_park
+static inline void
+read_park (struct saurion *const s, struct inbound *const in,
+           const uint32_t state, const uint32_t sel)
+{
+  if (!in->parked)
+    {
+      pthread_mutex_lock (&s->m_rings[sel]);
+      ++s->stats[sel].read_pauses;
+      pthread_mutex_unlock (&s->m_rings[sel]);
+      park_link (s, (int)(in - s->inbound), &s->parked[sel]);
+    }
+  in->parked = state;
+}
+
+// read_starve
+static inline void
+read_starve (struct saurion *const s, struct inbound *const in,
+             const uint32_t state, const uint32_t sel)
+{
+  pthread_mutex_lock (&s->m_rings[sel]);
+  ++s->stats[sel].buf_starved;
   pthread_mutex_unlock (&s->m_rings[sel]);
+  park_link (s, (int)(in - s->inbound), &s->starved[sel]);
+  in->parked = state;
+}
+
+// read_cancel
+static inline void
+read_cancel (struct saurion *const s, struct inbound *const in,
+             const uint32_t sel)
+{
+  // The receive ends with -ECANCELED, or with whatever it completed with
+  // first, and stays parked until the connection may be read again.
+  ring_lock (s, sel);
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  io_uring_prep_cancel (sqe, in->recv, 0);
+  io_uring_sqe_set_data (sqe, NULL);
+  ring_unlock (s, sel);
+  read_park (s, in, RECV_CANCELING, sel);
+}
+
+// read_resume
+static inline void
+read_resume (struct saurion *const s, const int fd, const uint32_t sel)
+{
+  if (fd < 0)
+    {
+      // The global budget fell under: every parked connection of the ring
+      // is checked again. It only happens after the instance was over it.
+      int next = s->parked[sel];
+      while (next >= 0)
+        {
+          const int i = next;
+          next = s->inbound[i].park_next;
+          read_resume (s, i, sel);
+        }
+      return;
+    }
+  struct inbound *const in = inbound_of (s, fd, sel);
+  // Connections waiting for a provided buffer are resumed as they return.
+  if (!in || !in->parked || in->parked >= READ_STARVED
+      || read_blocked (s, in))
+    {
+      return;
+    }
+  const uint32_t parked = in->parked;
+  in->parked = 0;
+  park_unlink (s, fd, &s->parked[sel]);
+  if (parked == READ_PARKED)
+    {
+      add_fd (s, fd, sel);
+    }
+  else if (parked == RECV_PARKED)
+    {
+      add_recv (s, in->recv, sel);
+    }
+  // A receive still being canceled arms itself again once it ends.
+}
+
+// read_unstarve
+static inline void
+read_unstarve (struct saurion *const s, const uint32_t sel)
+{
+  const int fd = s->starved[sel];
+  if (fd < 0)
+    {
+      return;
+    }
+  struct inbound *const in = &s->inbound[fd];
+  const uint32_t starved = in->parked;
+  park_unlink (s, fd, &s->starved[sel]);
+  in->parked = 0;
+  if (read_blocked (s, in))
+    {
+      read_park (s, in, (starved == READ_STARVED ? READ_PARKED : RECV_PARKED),
+                 sel);
+    }
+  else if (starved == READ_STARVED)
+    {
+      add_fd (s, fd, sel);
+    }
+  else
+    {
+      add_recv (s, in->recv, sel);
+    }
+}
+
+// provided_exhausted
+[[nodiscard]]
+static inline int
+provided_exhausted (const struct saurion *const s, const uint32_t sel)
+{
+  // Buffers not held by a lease are back in the ring, or about to be with
+  // a completion still to be handled, so a read only waits when none is.
+  const struct provided_buffers *const pb = s->provided[sel];
+  return pb->held_bids >= pb->entries;
+}
+
+// provided_recycle
+static inline void
+provided_recycle (struct saurion *const s, const uint32_t sel,
+                  const uint16_t bid)
+{
+  struct provided_buffers *const pb = s->provided[sel];
+  io_uring_buf_ring_add (pb->br, pb->bufs[bid], (unsigned)pb->chunk_sz, bid,
+                         io_uring_buf_ring_mask (pb->entries), 0);
+  io_uring_buf_ring_advance (pb->br, 1);
+  // Every buffer put back lets one connection waiting for it read again.
+  read_unstarve (s, sel);
+}
+
+// read_pause
+static inline void
+read_pause (struct saurion *const s, const int fd, const uint32_t sel)
+{
+  struct inbound *const in = inbound_of (s, fd, sel);
+  if (!in)
+    {
+      return;
+    }
+  in->paused = 1;
+  // A single read already posted still delivers what it gets.
+  if (!in->parked && in->recv)
+    {
+      read_cancel (s, in, sel);
+    }
+}
+
+// read_unpause
+static inline void
+read_unpause (struct saurion *const s, const int fd, const uint32_t sel)
+{
+  struct inbound *const in = inbound_of (s, fd, sel);
+  if (!in)
+    {
+      return;
+    }
+  in->paused = 0;
+  read_resume (s, fd, sel);
+}
+
+// read_kick
+static inline void
+read_kick (struct saurion *const s, const int fd)
+{
+  for (uint32_t i = 0; i < s->n_threads; ++i)
+    {
+      const uint32_t sel = (fd < 0 ? i : ring_of (s, fd));
+      if (owns_ring (s, sel))
+        {
+          read_resume (s, fd, sel);
+        }
+      else
+        {
+          inbox_post (s, sel, EV_BGT, fd, NULL);
+        }
+      if (fd >= 0)
+        {
+          return;
+        }
+    }
+}
+
+// read_hold
+static inline void
+read_hold (struct saurion *const s, const int fd, const uint64_t len)
+{
+  if (!read_limited (s))
+    {
+      return;
+    }
+  if (fd >= 0 && (uint32_t)fd < s->fd_ring_sz)
+    {
+      __atomic_add_fetch (&s->inbound[fd].msgs, 1, __ATOMIC_SEQ_CST);
+      __atomic_add_fetch (&s->inbound[fd].bytes, len, __ATOMIC_SEQ_CST);
+    }
+  __atomic_add_fetch (&s->held_msgs, 1, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch (&s->held_bytes, len, __ATOMIC_SEQ_CST);
+}
+
+// read_unhold
+static inline void
+read_unhold (struct saurion *const s, const int fd, const uint64_t len)
+{
+  const struct saurion_config *const c = &s->config;
+  if (!read_limited (s))
+    {
+      return;
+    }
+  // Connections are only parked while over a budget, so only the release
+  // that takes them under it has to wake them.
+  if (fd >= 0 && (uint32_t)fd < s->fd_ring_sz)
+    {
+      struct inbound *const in = &s->inbound[fd];
+      const uint32_t msgs = __atomic_fetch_sub (&in->msgs, 1, __ATOMIC_SEQ_CST);
+      const uint64_t bytes
+          = __atomic_fetch_sub (&in->bytes, len, __ATOMIC_SEQ_CST);
+      if ((c->read_max_msgs && msgs == c->read_max_msgs)
+          || (c->read_max_bytes && bytes >= c->read_max_bytes
+              && bytes - len < c->read_max_bytes))
+        {
+          read_kick (s, fd);
+        }
+    }
+  const uint32_t msgs
+      = __atomic_fetch_sub (&s->held_msgs, 1, __ATOMIC_SEQ_CST);
+  const uint64_t bytes
+      = __atomic_fetch_sub (&s->held_bytes, len, __ATOMIC_SEQ_CST);
+  if ((c->read_global_msgs && msgs == c->read_global_msgs)
+      || (c->read_global_bytes && bytes >= c->read_global_bytes
+          && bytes - len < c->read_global_bytes))
+    {
+      read_kick (s, -1);
+    }
+}
+
+// read_rearm
+static inline void
+read_rearm (struct saurion *const s, const int fd)
+{
+  const uint32_t sel = ring_of (s, fd);
+  struct inbound *const in = inbound_of (s, fd, sel);
+  if (in && read_blocked (s, in))
+    {
+      read_park (s, in, READ_PARKED, sel);
+      return;
+    }
+  add_read (s, fd);
+}
+
+// add_read_body
+static inline void
+add_read_body (struct saurion *const s, struct request *const req,
+               const int sel)
+{
+  ring_lock (s, sel);
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  io_uring_prep_readv (sqe, req->client_socket, &req->iov[0], 1, 0);
+  io_uring_sqe_set_data (sqe, req);
+  ring_unlock (s, sel);
+}
+
+// add_read_continue
+static inline void
+add_read_continue (struct saurion *const s, struct request *oreq,
+                   const int sel)
+{
+  if (!oreq->streaming)
+    {
+      // The rest of the message and its footer go straight into the buffer
+      // it is gathered in, so nothing is copied.
+      ring_lock (s, sel);
+      struct request *req = NULL;
+      while (!(req = (struct request *)slab_alloc (s->sends[sel], 1)))
+        {
+          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+        }
+      req->prev = oreq->prev;
+      req->prev_size = oreq->prev_size;
+      req->prev_remain = oreq->prev_remain;
+      req->next_iov = 0;
+      req->next_offset = 0;
+      req->retained = 0;
+      req->streaming = 0;
+      req->sent = 0;
+      req->next = NULL;
+      req->queue = NULL;
+      req->event_type = EV_BDY;
+      req->client_socket = oreq->client_socket;
+      req->iovec_count = 1;
+      req->iov[0].iov_base
+          = (uint8_t *)req->prev + (req->prev_size - req->prev_remain);
+      req->iov[0].iov_len = req->prev_remain + 1;
+      oreq->prev = NULL;
+      while ((req->handle = handle_table_insert (s->tables[sel], req))
+             == HANDLE_INVALID)
+        {
+          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+        }
+      ring_unlock (s, sel);
+      pthread_mutex_lock (&s->m_rings[sel]);
+      ++s->stats[sel].body_reads;
+      pthread_mutex_unlock (&s->m_rings[sel]);
+      add_read_body (s, req, sel);
+      return;
+    }
+  // A streamed message is read one chunk at a time.
+  const uint64_t want = MIN (oreq->prev_remain + 1, s->config.chunk_sz);
+  ring_lock (s, sel);
+  while (!set_request (&oreq, s->slabs[sel], s->tables[sel], want,
+                       s->config.chunk_sz, NULL, 0))
+    {
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  prep_read (s, sqe, oreq, sel);
+  io_uring_sqe_set_data (sqe, oreq);
+  ring_unlock (s, sel);
+}
+
+// outbound_of
+[[nodiscard]]
+static inline struct outbound *
+outbound_of (struct saurion *const s, const int fd, const uint32_t sel)
+{
+  // Only the worker of the ring a connection is pinned to writes to it, so
+  // its queue needs no lock. Unpinned descriptors write straight away.
+  if (fd < 0 || (uint32_t)fd >= s->fd_ring_sz
+      || __atomic_load_n (&s->fd_ring[fd], __ATOMIC_ACQUIRE) != sel + 1)
+    {
+      return NULL;
+    }
+  return &s->outbound[fd];
+}
+
+// send_closing
+[[nodiscard]]
+static inline int
+send_closing (struct saurion *const s, const int fd)
+{
+  return (fd >= 0 && (uint32_t)fd < s->fd_ring_sz
+          && __atomic_load_n (&s->outbound[fd].closing, __ATOMIC_ACQUIRE));
+}
+
+// send_over
+[[nodiscard]]
+static inline uint32_t
+send_over (struct saurion *const s, const int fd)
+{
+  uint32_t over = 0;
+  if (s->config.send_high_water && fd >= 0 && (uint32_t)fd < s->fd_ring_sz
+      && __atomic_load_n (&s->outbound[fd].pending, __ATOMIC_SEQ_CST)
+             >= s->config.send_high_water)
+    {
+      over |= OVER_CONN;
+    }
+  if (s->config.send_global_high
+      && __atomic_load_n (&s->pending, __ATOMIC_SEQ_CST)
+             >= s->config.send_global_high)
+    {
+      over |= OVER_GLOBAL;
+    }
+  return over;
+}
+
+// send_reserve
+static inline void
+send_reserve (struct saurion *const s, const int fd, const uint64_t bytes)
+{
+  if (s->config.send_high_water && fd >= 0 && (uint32_t)fd < s->fd_ring_sz)
+    {
+      __atomic_add_fetch (&s->outbound[fd].pending, bytes, __ATOMIC_SEQ_CST);
+    }
+  if (s->config.send_global_high)
+    {
+      __atomic_add_fetch (&s->pending, bytes, __ATOMIC_SEQ_CST);
+    }
+}
+
+// record_over_limit
+static inline void
+record_over_limit (struct saurion *const s, const int fd)
+{
+  const uint32_t sel = ring_of (s, fd);
+  pthread_mutex_lock (&s->m_rings[sel]);
+  ++s->stats[sel].over_limit;
+  pthread_mutex_unlock (&s->m_rings[sel]);
+}
+
+// send_mark
+static inline void
+send_mark (struct saurion *const s, const int fd, const uint32_t over)
+{
+  if (over & OVER_CONN)
+    {
+      __atomic_store_n (&s->outbound[fd].over, 1, __ATOMIC_SEQ_CST);
+    }
+  if (over & OVER_GLOBAL)
+    {
+      __atomic_store_n (&s->pending_over, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+// send_wait
+static inline void
+send_wait (struct saurion *const s, const int fd)
+{
+  pthread_mutex_lock (&s->drain_m);
+  __atomic_add_fetch (&s->drain_waiters, 1, __ATOMIC_SEQ_CST);
+  // Marked like a refused message, so the completion taking the queue to
+  // its low-water mark wakes the wait along with on_drain.
+  uint32_t over = 0;
+  while ((over = send_over (s, fd)))
+    {
+      send_mark (s, fd, over);
+      if (send_over (s, fd) == over)
+        {
+          pthread_cond_wait (&s->drain_c, &s->drain_m);
+        }
+    }
+  __atomic_sub_fetch (&s->drain_waiters, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock (&s->drain_m);
+}
+
+// send_refuse
+[[nodiscard]]
+static inline int
+send_refuse (struct saurion *const s, const int fd, const uint32_t over)
+{
+  send_mark (s, fd, over);
+  // Completions that fell under the limits before the flags were set did
+  // not report it, so the message is only refused if they were not.
+  if (!send_over (s, fd))
+    {
+      return ERROR_CODE;
+    }
+  record_over_limit (s, fd);
+  return SUCCESS_CODE;
+}
+
+// send_admit
+[[nodiscard]]
+static inline int
+send_admit (struct saurion *const s, const int fd, const uint64_t bytes)
+{
+  const uint32_t over = send_over (s, fd);
+  if (over && s->config.slow_consumer == SAURION_SLOW_BLOCK)
+    {
+      record_over_limit (s, fd);
+      // Workers are the ones draining the queues, so they never wait.
+      if (worker_of != s)
+        {
+          send_wait (s, fd);
+        }
+    }
+  else if (over && send_refuse (s, fd, over))
+    {
+      if (s->config.slow_consumer == SAURION_SLOW_DISCONNECT)
+        {
+          shutdown (fd, SHUT_RDWR);
+        }
+      return ERROR_CODE;
+    }
+  send_reserve (s, fd, bytes);
+  return SUCCESS_CODE;
+}
+
+// outbound_iov
+[[nodiscard]]
+static inline struct iovec *
+outbound_iov (struct outbound *const q, const uint64_t iovs)
+{
+  // Kept for the next writes of the connection, only ever growing.
+  if (iovs > q->iov_cap)
+    {
+      struct iovec *const iov
+          = (struct iovec *)realloc (q->iov, iovs * sizeof (struct iovec));
+      if (!iov)
+        {
+          return NULL;
+        }
+      q->iov = iov;
+      q->iov_cap = iovs;
+    }
+  return q->iov;
+}
+
+// flush_outbound
+static inline void
+flush_outbound (struct saurion *const s, struct outbound *const q,
+                const int sel)
+{
+  struct request *const head = q->head;
+  uint32_t n = 0;
+  uint64_t iovs = 0;
+  uint64_t bytes = 0;
+  const uint64_t max = s->config.send_coalesce_max;
+  for (struct request *r = head;
+       r
+       && (!n
+           || (iovs + r->iovec_count <= WRITE_IOV_MAX
+               && (!max || bytes < max)));
+       r = r->next)
+    {
+      iovs += r->iovec_count;
+      bytes += request_bytes (r) - (uint64_t)r->sent;
+      ++n;
+    }
+  struct iovec *const iov = (n > 1 ? outbound_iov (q, iovs) : NULL);
+  q->done = 0;
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  if (!iov)
+    {
+      // A lone message, or no memory to gather several: head goes alone.
+      q->inflight = 1;
+      q->bytes = request_bytes (head) - (uint64_t)head->sent;
+      prep_write (s, sqe, head, sel);
+      io_uring_sqe_set_data (sqe, head);
+      return;
+    }
+  q->bytes = bytes;
+  uint64_t pos = 0;
+  uint64_t off = 0;
+  request_resume (head, &pos, &off);
+  uint64_t count = 0;
+  struct request *r = head;
+  for (uint32_t i = 0; i < n; ++i, r = r->next)
+    {
+      for (uint64_t j = (r == head ? pos : 0); j < r->iovec_count; ++j)
+        {
+          iov[count++] = r->iov[j];
+        }
+    }
+  iov[0].iov_base = (uint8_t *)iov[0].iov_base + off;
+  iov[0].iov_len -= off;
+  q->inflight = n;
+  if (s->config.zc_threshold && bytes >= s->config.zc_threshold)
+    {
+      memset (&head->msg, 0, sizeof (head->msg));
+      head->msg.msg_iov = iov;
+      head->msg.msg_iovlen = count;
+      io_uring_prep_sendmsg_zc (sqe, head->client_socket, &head->msg, 0);
+      sqe->ioprio |= IORING_SEND_ZC_REPORT_USAGE;
+    }
+  else
+    {
+      io_uring_prep_writev (sqe, head->client_socket, iov, (unsigned)count,
+                            0);
+    }
+  io_uring_sqe_set_data (sqe, head);
+}
+
+// queue_write
+static inline void
+queue_write (struct saurion *const s, struct request *const req,
+             const int sel)
+{
+  struct outbound *const q = outbound_of (s, req->client_socket, sel);
+  if (!q)
+    {
+      struct io_uring_sqe *sqe = get_sqe (s, sel);
+      if (send_closing (s, req->client_socket))
+        {
+          // Closed with messages still queued, which a direct write could
+          // overtake. Completed without writing anything instead, so it is
+          // reported like any write making no progress.
+          io_uring_prep_nop (sqe);
+        }
+      else
+        {
+          prep_write (s, sqe, req, sel);
+        }
+      io_uring_sqe_set_data (sqe, req);
+      return;
+    }
+  req->queue = q;
+  if (q->tail)
+    {
+      q->tail->next = req;
+    }
+  else
+    {
+      q->head = req;
+    }
+  q->tail = req;
+  // Messages queued behind a write in flight leave together with the next
+  // one, once it completes.
+  if (!q->inflight)
+    {
+      flush_outbound (s, q, sel);
+    }
 }
 
 // add_write
@@ -378,41 +1922,166 @@ static inline void
 add_write (struct saurion *const s, const int fd, const char *const str,
            const int sel)
 {
-  int res = ERROR_CODE;
-  pthread_mutex_lock (&s->m_rings[sel]);
-  while (res != SUCCESS_CODE)
+  ring_lock (s, sel);
+  struct request *req = NULL;
+  while (!set_request (&req, s->slabs[sel], s->tables[sel], strlen (str),
+                       s->config.chunk_sz, (const void *const)str, 1))
     {
-      struct io_uring *ring = &s->rings[sel];
-      struct io_uring_sqe *sqe = io_uring_get_sqe (ring);
-      while (!sqe)
+      req = NULL;
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  req->event_type = EV_WRI;
+  req->client_socket = fd;
+  queue_write (s, req, sel);
+  ring_unlock (s, sel);
+}
+
+// add_write_buf
+static inline void
+add_write_buf (struct saurion *const s, const int fd, const void *const buf,
+               const uint64_t len, void *const token, const int sel)
+{
+  static const uint8_t footer = 0;
+  ring_lock (s, sel);
+  struct request *req = NULL;
+  while (!(req = (struct request *)slab_alloc (s->sends[sel], 1)))
+    {
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  req->prev = NULL;
+  req->prev_size = 0;
+  req->prev_remain = 0;
+  req->next_iov = 0;
+  req->next_offset = 0;
+  req->retained = 0;
+  req->streaming = 0;
+  req->sent = 0;
+  req->next = NULL;
+  req->queue = NULL;
+  req->event_type = EV_SND;
+  req->client_socket = fd;
+  req->token = token;
+  req->frame = htonll (len);
+  req->iovec_count = 3;
+  req->iov[0].iov_base = &req->frame;
+  req->iov[0].iov_len = sizeof (req->frame);
+  req->iov[1].iov_base = (void *)buf;
+  req->iov[1].iov_len = len;
+  req->iov[2].iov_base = (void *)&footer;
+  req->iov[2].iov_len = sizeof (footer);
+  while ((req->handle = handle_table_insert (s->tables[sel], req))
+         == HANDLE_INVALID)
+    {
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  queue_write (s, req, sel);
+  ring_unlock (s, sel);
+}
+
+// add_wait
+static inline void
+add_wait (struct saurion *const s, const int sel)
+{
+  struct inbox *const ib = &s->inboxes[sel];
+  ring_lock (s, sel);
+  struct request *req = NULL;
+  while (!set_request (&req, s->slabs[sel], s->tables[sel], 0,
+                       s->config.chunk_sz, NULL, 0))
+    {
+      req = NULL;
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  req->event_type = EV_WAI;
+  req->client_socket = ib->efd;
+  struct io_uring_sqe *sqe = get_sqe (s, sel);
+  io_uring_prep_read (sqe, ib->efd, &ib->value, sizeof (ib->value), 0);
+  io_uring_sqe_set_data (sqe, req);
+  ring_unlock (s, sel);
+}
+
+// lease_drop
+static inline void
+lease_drop (struct saurion *const s, struct saurion_lease *const l)
+{
+  if (l == worker_view.lease)
+    {
+      worker_view.lease = NULL;
+    }
+  // The completion still being handled releases its own buffer when done.
+  if (l->bid >= 0)
+    {
+      struct provided_buffers *const pb = s->provided[l->sel];
+      if (!--pb->held[l->bid])
         {
-          sqe = io_uring_get_sqe (ring);
-          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+          --pb->held_bids;
+          if (worker_view.bid != l->bid)
+            {
+              provided_recycle (s, l->sel, (uint16_t)l->bid);
+            }
+        }
+    }
+  else if (l->req)
+    {
+      if (!--l->req->retained && worker_view.req != l->req)
+        {
+          handle_table_delete (s->tables[l->sel], l->req->handle);
+        }
+    }
+  read_unhold (s, l->fd, l->len);
+  free (l);
+}
+
+// inbox_drain
+static inline void
+inbox_drain (struct saurion *const s, const int sel)
+{
+  struct inbox *const ib = &s->inboxes[sel];
+  struct inbox_msg *top
+      = atomic_exchange_explicit (&ib->head, NULL, memory_order_acquire);
+  // Producers push on top, so reverse the stack to handle the messages in
+  // the order they were posted.
+  struct inbox_msg *m = NULL;
+  while (top)
+    {
+      struct inbox_msg *const nxt = top->next;
+      top->next = m;
+      m = top;
+      top = nxt;
+    }
+  while (m)
+    {
+      struct inbox_msg *const nxt = m->next;
+      if (m->event_type == EV_REA)
+        {
+          add_fd (s, m->fd, sel);
+        }
+      else if (m->event_type == EV_REL)
+        {
+          lease_drop (s, (struct saurion_lease *)m->ptr);
+        }
+      else if (m->event_type == EV_SND)
+        {
+          add_write_buf (s, m->fd, m->ptr, m->len, m->token, sel);
+        }
+      else if (m->event_type == EV_PAU)
+        {
+          read_pause (s, m->fd, sel);
+        }
+      else if (m->event_type == EV_RES)
+        {
+          read_unpause (s, m->fd, sel);
         }
-      struct request *req = NULL;
-      if (!set_request (&req, &s->list, strlen (str), (const void *const)str,
-                        1))
+      else if (m->event_type == EV_BGT)
         {
-          free (sqe);
-          res = ERROR_CODE;
-          continue;
+          read_resume (s, m->fd, sel);
         }
-      req->event_type = EV_WRI;
-      req->client_socket = fd;
-      io_uring_prep_writev (sqe, req->client_socket, req->iov,
-                            req->iovec_count, 0);
-      io_uring_sqe_set_data (sqe, req);
-      if (io_uring_submit (ring) < 0)
+      else
         {
-          free (sqe);
-          list_delete_node (&s->list, req);
-          res = ERROR_CODE;
-          nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
-          continue;
+          add_write (s, m->fd, m->msg, sel);
         }
-      res = SUCCESS_CODE;
+      slab_free (m);
+      m = nxt;
     }
-  pthread_mutex_unlock (&s->m_rings[sel]);
 }
 
 /******************* HANDLERS *******************/
@@ -441,6 +2110,8 @@ calculate_max_iov_content (const struct request *req)
 
 struct chunk_params
 {
+  struct saurion *s;
+  struct slab *copies;
   void **dest;
   void *dest_ptr;
   uint64_t dest_off;
@@ -451,8 +2122,89 @@ struct chunk_params
   uint64_t curr_iov;
   uint64_t curr_iov_off;
   uint64_t *len;
+  struct iovec *views;
+  uint32_t n_views;
+  uint8_t more;
+  uint8_t oversize;
 };
 
+// request_pending
+[[nodiscard]]
+static inline int
+request_pending (const struct request *const req)
+{
+  return req->prev || req->streaming;
+}
+
+// stream_end
+static inline void
+stream_end (const struct saurion *const s, const int fd, const int err)
+{
+  if (s && s->cb.on_read_end)
+    {
+      s->cb.on_read_end (fd, err, s->cb.on_read_end_arg);
+    }
+}
+
+// message_allowed
+[[nodiscard]]
+static inline int
+message_allowed (struct chunk_params *const p)
+{
+  if (p->s && p->s->config.max_msg_size
+      && p->cont_sz > p->s->config.max_msg_size)
+    {
+      p->oversize = 1;
+      return ERROR_CODE;
+    }
+  return SUCCESS_CODE;
+}
+
+// message_fits
+[[nodiscard]]
+static inline int
+message_fits (const struct chunk_params *const p)
+{
+  uint64_t pos = p->curr_iov_off;
+  for (uint64_t i = 0; i < p->curr_iov; ++i)
+    {
+      pos += p->req->iov[i].iov_len;
+    }
+  // The footer has to be in this read too for the message to end in it.
+  return (pos + p->cont_rem + 1) <= p->max_iov_cont;
+}
+
+// message_spans
+[[nodiscard]]
+static inline int
+message_spans (struct chunk_params *const p)
+{
+  p->more = 1;
+  *p->dest = NULL;
+  *p->len = 0;
+  if (p->s && p->s->cb.on_read_chunk)
+    {
+      p->req->streaming = 1;
+      p->dest_ptr = NULL;
+      if (p->s->cb.on_read_begin)
+        {
+          p->s->cb.on_read_begin (p->req->client_socket, (int64_t)p->cont_sz,
+                                  p->s->cb.on_read_begin_arg);
+        }
+      return SUCCESS_CODE;
+    }
+  // With room for the footer, which the follow-up reads bring along.
+  p->req->prev = (p->cont_sz < UINT64_MAX
+                      ? copy_alloc (p->copies, p->cont_sz + 1)
+                      : NULL);
+  if (!p->req->prev)
+    {
+      return ERROR_CODE;
+    }
+  p->dest_ptr = p->req->prev;
+  return SUCCESS_CODE;
+}
+
 // handle_previous_message
 [[nodiscard]]
 static inline int
@@ -462,7 +2214,7 @@ handle_previous_message (struct chunk_params *p)
   p->cont_rem = p->req->prev_remain;
   p->dest_off = p->cont_sz - p->cont_rem;
 
-  if (p->cont_rem <= p->max_iov_cont)
+  if (p->cont_rem < p->max_iov_cont)
     {
       *p->dest = p->req->prev;
       p->dest_ptr = *p->dest;
@@ -474,6 +2226,7 @@ handle_previous_message (struct chunk_params *p)
     {
       p->dest_ptr = p->req->prev;
       *p->dest = NULL;
+      p->more = 1;
     }
   return SUCCESS_CODE;
 }
@@ -492,28 +2245,28 @@ handle_partial_message (struct chunk_params *p)
   p->curr_iov_off += sizeof (uint64_t);
   p->cont_rem = p->cont_sz;
   p->dest_off = p->cont_sz - p->cont_rem;
+  if (!message_allowed (p))
+    {
+      return ERROR_CODE;
+    }
 
-  if ((p->curr_iov_off + p->cont_rem + 1) <= p->max_iov_cont)
+  if (message_fits (p))
     {
-      *p->dest = malloc (p->cont_sz);
-      if (!*p->dest)
+      if (p->views)
         {
-          return ERROR_CODE;
+          *p->dest = NULL;
+          p->dest_ptr = NULL;
+          return SUCCESS_CODE;
         }
-      p->dest_ptr = *p->dest;
-    }
-  else
-    {
-      p->req->prev = malloc (p->cont_sz);
-      if (!p->req->prev)
+      *p->dest = copy_alloc (p->copies, p->cont_sz);
+      if (!*p->dest)
         {
           return ERROR_CODE;
         }
-      p->dest_ptr = p->req->prev;
-      *p->dest = NULL;
-      *p->len = 0;
+      p->dest_ptr = *p->dest;
+      return SUCCESS_CODE;
     }
-  return SUCCESS_CODE;
+  return message_spans (p);
 }
 
 // handle_new_message
@@ -530,27 +2283,28 @@ handle_new_message (struct chunk_params *p)
   p->curr_iov_off += sizeof (uint64_t);
   p->cont_rem = p->cont_sz;
   p->dest_off = p->cont_sz - p->cont_rem;
+  if (!message_allowed (p))
+    {
+      return ERROR_CODE;
+    }
 
-  if (p->cont_rem <= p->max_iov_cont)
+  if (message_fits (p))
     {
-      *p->dest = malloc (p->cont_sz);
-      if (!*p->dest)
+      if (p->views)
         {
-          return ERROR_CODE; // Error al asignar memoria.
+          *p->dest = NULL;
+          p->dest_ptr = NULL;
+          return SUCCESS_CODE;
         }
-      p->dest_ptr = *p->dest;
-    }
-  else
-    {
-      p->req->prev = malloc (p->cont_sz);
-      if (!p->req->prev)
+      *p->dest = copy_alloc (p->copies, p->cont_sz);
+      if (!*p->dest)
         {
           return ERROR_CODE; // Error al asignar memoria.
         }
-      p->dest_ptr = p->req->prev;
-      *p->dest = NULL;
+      p->dest_ptr = *p->dest;
+      return SUCCESS_CODE;
     }
-  return SUCCESS_CODE;
+  return message_spans (p);
 }
 
 // prepare_destination
@@ -558,7 +2312,7 @@ handle_new_message (struct chunk_params *p)
 static inline int
 prepare_destination (struct chunk_params *p)
 {
-  if (p->req->prev && p->req->prev_size && p->req->prev_remain)
+  if (request_pending (p->req))
     {
       return handle_previous_message (p);
     }
@@ -579,15 +2333,45 @@ copy_data (struct chunk_params *p, uint8_t *const ok)
     {
       curr_iov_msg_rem = MIN (
           p->cont_rem, (p->req->iov[p->curr_iov].iov_len - p->curr_iov_off));
-      memcpy ((uint8_t *)p->dest_ptr + p->dest_off,
-              (uint8_t *)p->req->iov[p->curr_iov].iov_base + p->curr_iov_off,
-              curr_iov_msg_rem);
+      uint8_t *const src
+          = (uint8_t *)p->req->iov[p->curr_iov].iov_base + p->curr_iov_off;
+      if (p->dest_ptr)
+        {
+          memcpy ((uint8_t *)p->dest_ptr + p->dest_off, src,
+                  curr_iov_msg_rem);
+        }
+      else if (p->req->streaming)
+        {
+          if (curr_iov_msg_rem)
+            {
+              p->s->cb.on_read_chunk (p->req->client_socket, src,
+                                      (int64_t)curr_iov_msg_rem,
+                                      p->s->cb.on_read_chunk_arg);
+            }
+        }
+      else if (curr_iov_msg_rem || !p->n_views)
+        {
+          // Borrowed views: describe the payload where it was received.
+          // Only an empty message keeps an empty view.
+          if (p->n_views && !p->views[p->n_views - 1].iov_len)
+            {
+              --p->n_views;
+            }
+          p->views[p->n_views].iov_base = src;
+          p->views[p->n_views].iov_len = curr_iov_msg_rem;
+          ++p->n_views;
+        }
       p->dest_off += curr_iov_msg_rem;
       p->curr_iov_off += curr_iov_msg_rem;
       p->cont_rem -= curr_iov_msg_rem;
 
       if (p->cont_rem <= 0)
         {
+          // The footer comes with the next read.
+          if (p->more)
+            {
+              break;
+            }
           if (*(((uint8_t *)p->req->iov[p->curr_iov].iov_base)
                 + p->curr_iov_off)
               != 0)
@@ -615,7 +2399,7 @@ copy_data (struct chunk_params *p, uint8_t *const ok)
 static inline uint8_t
 validate_and_update (struct chunk_params *const p, const uint8_t ok)
 {
-  if (p->req->prev)
+  if (p->more)
     {
       p->req->prev_size = p->cont_sz;
       p->req->prev_remain = p->cont_rem;
@@ -624,138 +2408,430 @@ validate_and_update (struct chunk_params *const p, const uint8_t ok)
     }
   else
     {
-      p->req->prev_size = 0;
-      p->req->prev_remain = 0;
+      p->req->prev_size = 0;
+      p->req->prev_remain = 0;
+      if (p->req->streaming)
+        {
+          p->req->streaming = 0;
+          stream_end (p->s, p->req->client_socket, (ok ? 0 : -EBADMSG));
+        }
+    }
+  if (p->curr_iov < p->req->iovec_count)
+    {
+      uint64_t next_sz
+          = *(uint64_t *)(((uint8_t *)p->req->iov[p->curr_iov].iov_base)
+                          + p->curr_iov_off);
+      if ((p->req->iov[p->curr_iov].iov_len > p->curr_iov_off) && next_sz)
+        {
+          p->req->next_iov = p->curr_iov;
+          p->req->next_offset = p->curr_iov_off;
+        }
+      else
+        {
+          p->req->next_iov = 0;
+          p->req->next_offset = 0;
+        }
+    }
+
+  return ok ? SUCCESS_CODE : ERROR_CODE;
+}
+
+// read_chunk_free
+static inline void
+read_chunk_free (struct chunk_params *const p)
+{
+  copy_free (p->copies, p->dest_ptr);
+  p->dest_ptr = NULL;
+  *p->dest = NULL;
+  *p->len = 0;
+  p->req->next_iov = 0;
+  p->req->next_offset = 0;
+  for (uint64_t i = p->curr_iov; i < p->req->iovec_count; ++i)
+    {
+      for (uint64_t j = p->curr_iov_off; j < p->req->iov[i].iov_len; ++j)
+        {
+          uint8_t foot = *((uint8_t *)p->req->iov[i].iov_base) + j;
+          if (foot == 0)
+            {
+              p->req->next_iov = i;
+              p->req->next_offset = (j + 1) % p->req->iov[i].iov_len;
+              return;
+            }
+        }
+    }
+}
+
+// read_message
+[[nodiscard]]
+static int
+read_message (struct chunk_params *const p)
+{
+  if (p->req->iovec_count == 0)
+    {
+      return ERROR_CODE;
+    }
+  p->max_iov_cont = calculate_max_iov_content (p->req);
+  p->cont_sz = 0;
+  p->cont_rem = 0;
+  p->curr_iov = 0;
+  p->curr_iov_off = 0;
+  p->dest_off = 0;
+  p->dest_ptr = NULL;
+  p->n_views = 0;
+  p->more = 0;
+  p->oversize = 0;
+
+  if (!prepare_destination (p))
+    {
+      return ERROR_CODE;
+    }
+
+  uint8_t ok = 1UL;
+  copy_data (p, &ok);
+
+  if (validate_and_update (p, ok))
+    {
+      return SUCCESS_CODE;
+    }
+  read_chunk_free (p);
+  return ERROR_CODE;
+}
+
+// read_chunk
+[[nodiscard]]
+int
+read_chunk (void **dest, uint64_t *const len, struct request *const req)
+{
+  struct chunk_params p;
+  p.s = NULL;
+  p.copies = NULL;
+  p.req = req;
+  p.dest = dest;
+  p.len = len;
+  p.views = NULL;
+  return read_message (&p);
+}
+
+// handle_message
+static inline void
+handle_message (struct saurion *const s, const int fd, void **const msg,
+                const uint64_t len, const struct iovec *const views,
+                const uint32_t n_views)
+{
+  if (s->cb.on_readv && (n_views || *msg))
+    {
+      struct iovec whole = { *msg, len };
+      worker_view.heap = *msg;
+      worker_view.lease = NULL;
+      worker_view.active = 1;
+      worker_view.fd = fd;
+      worker_view.len = len;
+      s->cb.on_readv (fd, (n_views ? views : &whole), (n_views ? n_views : 1),
+                      (int64_t)len, s->cb.on_readv_arg);
+      worker_view.active = 0;
+      worker_view.lease = NULL;
+      // A retained copy now belongs to its lease.
+      *msg = worker_view.heap;
+      worker_view.heap = NULL;
+    }
+  else if (s->cb.on_readed && *msg)
+    {
+      s->cb.on_readed (fd, *msg, len, s->cb.on_readed_arg);
+    }
+  slab_free (*msg);
+  *msg = NULL;
+}
+
+// read_oversize
+static inline void
+read_oversize (struct saurion *const s, const int fd, const uint32_t sel)
+{
+  struct inbound *const in = inbound_of (s, fd, sel);
+  pthread_mutex_lock (&s->m_rings[sel]);
+  ++s->stats[sel].oversized;
+  pthread_mutex_unlock (&s->m_rings[sel]);
+  // Whatever the peer still sends is dropped until it closes.
+  if (in)
+    {
+      in->discard = 1;
+    }
+  if (s->cb.on_error)
+    {
+      const char *resp = "EMSGSIZE";
+      s->cb.on_error (fd, resp, (int64_t)strlen (resp), s->cb.on_error_arg);
+    }
+  shutdown (fd, SHUT_RDWR);
+}
+
+// read_abort
+static inline void
+read_abort (const struct saurion *const s, struct request *const req)
+{
+  if (req->streaming)
+    {
+      req->streaming = 0;
+      stream_end (s, req->client_socket, -ECONNRESET);
+    }
+  slab_free (req->prev);
+  req->prev = NULL;
+}
+
+// handle_read
+static inline void
+handle_read (struct saurion *const s, struct request *const req,
+             const int rearm, const uint32_t sel)
+{
+  const int fd = req->client_socket;
+  const struct inbound *const in = inbound_of (s, fd, sel);
+  if (in && in->discard)
+    {
+      if (rearm)
+        {
+          read_rearm (s, fd);
+        }
+      return;
+    }
+  void *msg = NULL;
+  uint64_t len = 0;
+  struct iovec views[VIEW_IOV_MAX];
+  struct chunk_params p;
+  p.s = s;
+  p.copies = s->copies[sel];
+  p.req = req;
+  p.dest = &msg;
+  p.len = &len;
+  p.views = NULL;
+  if (s->cb.on_readv && req->iovec_count <= VIEW_IOV_MAX)
+    {
+      p.views = views;
+    }
+  while (1)
+    {
+      if (!read_message (&p))
+        {
+          if (p.oversize)
+            {
+              read_oversize (s, fd, sel);
+            }
+          break;
+        }
+      if (req->next_iov || req->next_offset)
+        {
+          handle_message (s, req->client_socket, &msg, len, views, p.n_views);
+          continue;
+        }
+      if (request_pending (req))
+        {
+          if (rearm)
+            {
+              add_read_continue (s, req, sel);
+            }
+          return;
+        }
+      handle_message (s, req->client_socket, &msg, len, views, p.n_views);
+      break;
+    }
+  if (rearm)
+    {
+      read_rearm (s, req->client_socket);
+    }
+}
+
+// view_source
+static inline void
+view_source (struct request *const req, const uint32_t sel,
+             const int32_t bid)
+{
+  worker_view.req = req;
+  worker_view.sel = sel;
+  worker_view.bid = bid;
+}
+
+// handle_write
+static inline void
+handle_write (const struct saurion *const s, const int fd)
+{
+  if (s->cb.on_wrote)
+    {
+      s->cb.on_wrote (fd, s->cb.on_wrote_arg);
+    }
+}
+
+// handle_send
+static inline void
+handle_send (const struct saurion *const s, const struct request *const req,
+             const int res)
+{
+  if (s->cb.on_sent)
+    {
+      s->cb.on_sent (req->client_socket, req->token, res, s->cb.on_sent_arg);
+    }
+}
+
+// handle_drain
+static inline void
+handle_drain (struct saurion *const s, const int fd)
+{
+  if (__atomic_load_n (&s->drain_waiters, __ATOMIC_SEQ_CST))
+    {
+      pthread_mutex_lock (&s->drain_m);
+      pthread_cond_broadcast (&s->drain_c);
+      pthread_mutex_unlock (&s->drain_m);
     }
-  if (p->curr_iov < p->req->iovec_count)
+  if (s->cb.on_drain)
     {
-      uint64_t next_sz
-          = *(uint64_t *)(((uint8_t *)p->req->iov[p->curr_iov].iov_base)
-                          + p->curr_iov_off);
-      if ((p->req->iov[p->curr_iov].iov_len > p->curr_iov_off) && next_sz)
-        {
-          p->req->next_iov = p->curr_iov;
-          p->req->next_offset = p->curr_iov_off;
-        }
-      else
-        {
-          p->req->next_iov = 0;
-          p->req->next_offset = 0;
-        }
+      s->cb.on_drain (fd, s->cb.on_drain_arg);
     }
-
-  return ok ? SUCCESS_CODE : ERROR_CODE;
 }
 
-// read_chunk_free
+// send_release
 static inline void
-read_chunk_free (struct chunk_params *const p)
+send_release (struct saurion *const s, const int fd, const uint64_t bytes)
 {
-  free (p->dest_ptr);
-  p->dest_ptr = NULL;
-  *p->dest = NULL;
-  *p->len = 0;
-  p->req->next_iov = 0;
-  p->req->next_offset = 0;
-  for (uint64_t i = p->curr_iov; i < p->req->iovec_count; ++i)
+  if (s->config.send_high_water && fd >= 0 && (uint32_t)fd < s->fd_ring_sz)
     {
-      for (uint64_t j = p->curr_iov_off; j < p->req->iov[i].iov_len; ++j)
+      struct outbound *const q = &s->outbound[fd];
+      if (__atomic_sub_fetch (&q->pending, bytes, __ATOMIC_SEQ_CST)
+              <= s->config.send_low_water
+          && __atomic_exchange_n (&q->over, 0, __ATOMIC_SEQ_CST))
         {
-          uint8_t foot = *((uint8_t *)p->req->iov[i].iov_base) + j;
-          if (foot == 0)
-            {
-              p->req->next_iov = i;
-              p->req->next_offset = (j + 1) % p->req->iov[i].iov_len;
-              return;
-            }
+          handle_drain (s, fd);
         }
     }
+  if (s->config.send_global_high
+      && __atomic_sub_fetch (&s->pending, bytes, __ATOMIC_SEQ_CST)
+             <= s->config.send_global_low
+      && __atomic_exchange_n (&s->pending_over, 0, __ATOMIC_SEQ_CST))
+    {
+      handle_drain (s, -1);
+    }
 }
 
-// read_chunk
-[[nodiscard]]
-int
-read_chunk (void **dest, uint64_t *const len, struct request *const req)
+// write_done
+static inline void
+write_done (struct saurion *const s, struct request *const req, const int res,
+            const int sel)
 {
-  struct chunk_params p;
-  p.req = req;
-  p.dest = dest;
-  p.len = len;
-  if (p.req->iovec_count == 0)
+  send_release (s, req->client_socket, request_bytes (req));
+  if (req->event_type == EV_SND)
     {
-      return ERROR_CODE;
+      handle_send (s, req, res);
     }
-
-  p.max_iov_cont = calculate_max_iov_content (p.req);
-  p.cont_sz = 0;
-  p.cont_rem = 0;
-  p.curr_iov = 0;
-  p.curr_iov_off = 0;
-  p.dest_off = 0;
-  p.dest_ptr = NULL;
-  if (!prepare_destination (&p))
+  else if (res >= 0)
     {
-      return ERROR_CODE;
+      handle_write (s, req->client_socket);
     }
+  handle_table_delete (s->tables[sel], req->handle);
+}
 
-  uint8_t ok = 1UL;
-  copy_data (&p, &ok);
-
-  if (validate_and_update (&p, ok))
+// outbound_complete
+static inline void
+outbound_complete (struct saurion *const s, struct outbound *const q,
+                   const int sel)
+{
+  const int res = (q->done < 0 ? (int)q->done : 0);
+  uint64_t done = (q->done > 0 ? (uint64_t)q->done : 0);
+  uint32_t n = q->inflight;
+  pthread_mutex_lock (&s->m_rings[sel]);
+  s->stats[sel].coalesced += n - 1;
+  if (!res && done < q->bytes)
     {
-      return SUCCESS_CODE;
+      ++s->stats[sel].short_writes;
+    }
+  pthread_mutex_unlock (&s->m_rings[sel]);
+  // Still in flight while the callbacks run, so the messages they send are
+  // only queued. An error fails everything queued for the connection.
+  while (q->head && (res || n))
+    {
+      struct request *const r = q->head;
+      if (!res)
+        {
+          const uint64_t left = request_bytes (r) - (uint64_t)r->sent;
+          if (done < left)
+            {
+              r->sent += (int64_t)done;
+              break;
+            }
+          done -= left;
+          --n;
+        }
+      q->head = r->next;
+      if (!q->head)
+        {
+          q->tail = NULL;
+        }
+      write_done (s, r, res, sel);
+    }
+  q->inflight = 0;
+  if (q->head)
+    {
+      ring_lock (s, sel);
+      flush_outbound (s, q, sel);
+      ring_unlock (s, sel);
+      return;
+    }
+  if (q->closing)
+    {
+      __atomic_store_n (&q->closing, 0, __ATOMIC_RELEASE);
+      close ((int)(q - s->outbound));
     }
-  read_chunk_free (&p);
-  return ERROR_CODE;
 }
 
-// handle_read
+// handle_event_write
 static inline void
-handle_read (struct saurion *const s, struct request *const req)
+handle_event_write (struct saurion *const s,
+                    const struct io_uring_cqe *const cqe,
+                    struct request *const req, const int sel)
 {
-  void *msg = NULL;
-  uint64_t len = 0;
-  while (1)
+  if (!(cqe->flags & IORING_CQE_F_NOTIF))
     {
-      if (!read_chunk (&msg, &len, req))
+      // A write that makes no progress would be resubmitted forever.
+      const int64_t res = (cqe->res > 0   ? cqe->res
+                           : cqe->res < 0 ? cqe->res
+                                          : -EPIPE);
+      if (req->queue)
         {
-          break;
+          req->queue->done = res;
         }
-      if (req->next_iov || req->next_offset)
+      else
         {
-          if (s->cb.on_readed && msg)
-            {
-              s->cb.on_readed (req->client_socket, msg, len,
-                               s->cb.on_readed_arg);
-            }
-          free (msg);
-          msg = NULL;
-          continue;
+          req->sent = (res > 0 ? req->sent + res : res);
         }
-      if (req->prev && req->prev_size && req->prev_remain)
+      if (cqe->flags & IORING_CQE_F_MORE)
         {
-          add_read_continue (s, req, next (s));
+          // Zero-copy send: the buffers are still in use until the
+          // notification with the same request arrives.
           return;
         }
-      if (s->cb.on_readed && msg)
+    }
+  else
+    {
+      pthread_mutex_lock (&s->m_rings[sel]);
+      ++s->stats[sel].zc_sends;
+      if ((uint32_t)cqe->res & IORING_NOTIF_USAGE_ZC_COPIED)
         {
-          s->cb.on_readed (req->client_socket, msg, len, s->cb.on_readed_arg);
+          ++s->stats[sel].zc_copied;
         }
-      free (msg);
-      msg = NULL;
-      break;
+      pthread_mutex_unlock (&s->m_rings[sel]);
     }
-  add_read (s, req->client_socket);
-}
-
-// handle_write
-static inline void
-handle_write (const struct saurion *const s, const int fd)
-{
-  if (s->cb.on_wrote)
+  if (req->queue)
     {
-      s->cb.on_wrote (fd, s->cb.on_wrote_arg);
+      outbound_complete (s, req->queue, sel);
+      return;
+    }
+  if (req->sent > 0 && (uint64_t)req->sent < request_bytes (req))
+    {
+      pthread_mutex_lock (&s->m_rings[sel]);
+      ++s->stats[sel].short_writes;
+      pthread_mutex_unlock (&s->m_rings[sel]);
+      ring_lock (s, sel);
+      struct io_uring_sqe *sqe = get_sqe (s, sel);
+      prep_write (s, sqe, req, sel);
+      io_uring_sqe_set_data (sqe, req);
+      ring_unlock (s, sel);
+      return;
     }
+  write_done (s, req, (req->sent < 0 ? (int)req->sent : 0), sel);
 }
 
 // handle_error
@@ -772,19 +2848,49 @@ handle_error (const struct saurion *const s, const struct request *const req)
 
 // handle_close
 static inline void
-handle_close (const struct saurion *const s, const struct request *const req)
+handle_close (struct saurion *const s, const struct request *const req)
 {
+  const int fd = req->client_socket;
+  if ((uint32_t)fd < s->fd_ring_sz && s->inbound[fd].parked)
+    {
+      // Off the parked list of its ring while it is still pinned to it.
+      park_unlink (s, fd, park_list (s, &s->inbound[fd], ring_of (s, fd)));
+      s->inbound[fd].parked = 0;
+    }
+  // Messages still queued keep the descriptor, so it is neither reused by
+  // a new connection nor closed under them until the queue is empty. Marked
+  // before it is unpinned, so new messages are refused rather than written
+  // ahead of them.
+  const int queued = ((uint32_t)fd < s->fd_ring_sz && s->outbound[fd].head);
+  if (queued)
+    {
+      __atomic_store_n (&s->outbound[fd].closing, 1, __ATOMIC_RELEASE);
+    }
+  // Unpinned before closing, while the descriptor cannot be reused yet.
+  unpin_ring (s, req->client_socket);
   if (s->cb.on_closed)
     {
       s->cb.on_closed (req->client_socket, s->cb.on_closed_arg);
     }
-  close (req->client_socket);
+  if ((uint32_t)fd < s->fd_ring_sz)
+    {
+      s->inbound[fd].recv = NULL;
+      s->inbound[fd].paused = 0;
+      s->inbound[fd].parked = 0;
+      s->inbound[fd].discard = 0;
+    }
+  if (queued)
+    {
+      return;
+    }
+  close (fd);
 }
 
 /******************* INTERFACE *******************/
-// saurion_set_socket
-[[nodiscard]] int
-saurion_set_socket (const int p)
+// open_listener
+[[nodiscard]]
+static int
+open_listener (const int p, const int reuseport)
 {
   int sock = 0;
   struct sockaddr_in srv_addr;
@@ -798,6 +2904,14 @@ saurion_set_socket (const int p)
   int enable = 1;
   if (setsockopt (sock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof (int)) < 0)
     {
+      close (sock);
+      return ERROR_CODE;
+    }
+  if (reuseport
+      && setsockopt (sock, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof (int))
+             < 0)
+    {
+      close (sock);
       return ERROR_CODE;
     }
   struct timeval t_out;
@@ -805,6 +2919,7 @@ saurion_set_socket (const int p)
   t_out.tv_usec = TIMEOUT_IDLE % 1000L;
   if (setsockopt (sock, SOL_SOCKET, SO_RCVTIMEO, &t_out, sizeof (t_out)) < 0)
     {
+      close (sock);
       return ERROR_CODE;
     }
 
@@ -815,30 +2930,230 @@ saurion_set_socket (const int p)
 
   if (bind (sock, (const struct sockaddr *)&srv_addr, sizeof (srv_addr)) < 0)
     {
+      close (sock);
       return ERROR_CODE;
     }
 
   constexpr int num_queue = (ACCEPT_QUEUE > 0 ? ACCEPT_QUEUE : SOMAXCONN);
   if (listen (sock, num_queue) < 0)
     {
+      close (sock);
       return ERROR_CODE;
     }
 
   return sock;
 }
 
+// saurion_set_socket
+[[nodiscard]] int
+saurion_set_socket (const int p)
+{
+  return open_listener (p, 0);
+}
+
+// saurion_set_sockets
+[[nodiscard]] int
+saurion_set_sockets (struct saurion *const s, const int p)
+{
+  if (!s->config.reuseport)
+    {
+      s->ss = saurion_set_socket (p);
+      return (s->ss ? SUCCESS_CODE : ERROR_CODE);
+    }
+  int *listeners = (int *)malloc (s->n_threads * sizeof (int));
+  if (!listeners)
+    {
+      return ERROR_CODE;
+    }
+  for (uint32_t i = 0; i < s->n_threads; ++i)
+    {
+      listeners[i] = open_listener (p, 1);
+      if (!listeners[i])
+        {
+          for (uint32_t j = 0; j < i; ++j)
+            {
+              close (listeners[j]);
+            }
+          free (listeners);
+          return ERROR_CODE;
+        }
+    }
+  s->ss = listeners[0];
+  s->listeners = listeners;
+  return SUCCESS_CODE;
+}
+
+// register_chunks
+static inline uint32_t
+register_chunks (struct io_uring *const ring, struct chunk_pool *const pool)
+{
+  if (CHUNK_POOL_FIXED == 0 || !chunk_pool_reserve (pool, CHUNK_POOL_FIXED))
+    {
+      return 0;
+    }
+  struct iovec iovs[CHUNK_POOL_FIXED > 0 ? CHUNK_POOL_FIXED : 1];
+  uint32_t n = chunk_pool_regions (pool, iovs, CHUNK_POOL_FIXED);
+  if (io_uring_register_buffers (ring, iovs, n) < 0)
+    {
+      return 0;
+    }
+  return n;
+}
+
+// inbox_init
+[[nodiscard]]
+static int
+inbox_init (struct inbox *const ib)
+{
+  atomic_init (&ib->head, NULL);
+  ib->value = 0;
+  ib->efd = eventfd (0, EFD_NONBLOCK);
+  return (ib->efd < 0 ? ERROR_CODE : SUCCESS_CODE);
+}
+
+// inbox_fini
+static void
+inbox_fini (struct inbox *const ib)
+{
+  if (!ib || ib->efd < 0)
+    {
+      return;
+    }
+  struct inbox_msg *m = atomic_exchange (&ib->head, NULL);
+  while (m)
+    {
+      struct inbox_msg *const nxt = m->next;
+      slab_free (m);
+      m = nxt;
+    }
+  close (ib->efd);
+  ib->efd = -1;
+}
+
+// send_zc_supported
+[[nodiscard]]
+static inline int
+send_zc_supported (struct io_uring *const ring)
+{
+  struct io_uring_probe *probe = io_uring_get_probe_ring (ring);
+  if (!probe)
+    {
+      return ERROR_CODE;
+    }
+  const int ok = io_uring_opcode_supported (probe, IORING_OP_SENDMSG_ZC);
+  io_uring_free_probe (probe);
+  return (ok ? SUCCESS_CODE : ERROR_CODE);
+}
+
+// saurion_config_default
+void
+saurion_config_default (struct saurion_config *const cfg)
+{
+  cfg->n_threads = NUM_CORES;
+  cfg->ring_entries = SAURION_RING_SIZE;
+  cfg->cq_entries = 0;
+  cfg->chunk_sz = CHUNK_SZ;
+  cfg->setup_flags = (SQPOLL ? IORING_SETUP_SQPOLL : 0);
+  cfg->sq_thread_idle = SQPOLL_IDLE;
+  cfg->sq_thread_cpu = SQPOLL_CPU;
+  cfg->single_issuer = SINGLE_ISSUER;
+  cfg->affinity = RING_AFFINITY;
+  cfg->pick_ring = NULL;
+  cfg->pick_ring_arg = NULL;
+  cfg->reuseport = REUSEPORT;
+  cfg->max_ring_entries = SAURION_RING_MAX;
+  cfg->buf_ring_entries = BUF_RING_ENTRIES;
+  cfg->recv_multishot = RECV_MULTISHOT;
+  cfg->zc_threshold = SEND_ZC_THRESHOLD;
+  cfg->send_coalesce_max = SEND_COALESCE_MAX;
+  cfg->send_high_water = SEND_HIGH_WATER;
+  cfg->send_low_water = SEND_LOW_WATER;
+  cfg->send_global_high = SEND_GLOBAL_HIGH;
+  cfg->send_global_low = SEND_GLOBAL_LOW;
+  cfg->slow_consumer = SLOW_CONSUMER;
+  cfg->read_max_msgs = READ_MAX_MSGS;
+  cfg->read_max_bytes = READ_MAX_BYTES;
+  cfg->read_global_msgs = READ_GLOBAL_MSGS;
+  cfg->read_global_bytes = READ_GLOBAL_BYTES;
+  cfg->max_msg_size = MAX_MSG_SIZE;
+}
+
+// init_ring
+static inline int
+init_ring (struct io_uring *const ring, const struct saurion_config *const cfg,
+           const uint32_t idx)
+{
+  struct io_uring_params params;
+  memset (&params, 0, sizeof (params));
+  params.flags = cfg->setup_flags;
+  if (cfg->cq_entries)
+    {
+      params.flags |= IORING_SETUP_CQSIZE;
+      params.cq_entries = cfg->cq_entries;
+    }
+  if (cfg->single_issuer)
+    {
+      // Created disabled so the owning worker becomes the issuer when it
+      // enables the ring.
+      params.flags |= IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_R_DISABLED;
+      if (!(params.flags & IORING_SETUP_SQPOLL))
+        {
+          params.flags
+              |= IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_COOP_TASKRUN;
+        }
+    }
+  if (params.flags & IORING_SETUP_SQPOLL)
+    {
+      params.sq_thread_idle = cfg->sq_thread_idle;
+      if (cfg->sq_thread_cpu >= 0)
+        {
+          params.flags |= IORING_SETUP_SQ_AFF;
+          params.sq_thread_cpu
+              = (uint32_t)((cfg->sq_thread_cpu + idx) % NUM_CORES);
+        }
+    }
+  return io_uring_queue_init_params (cfg->ring_entries, ring, &params);
+}
+
 // saurion_create
 [[nodiscard]]
 struct saurion *
 saurion_create (uint32_t n_threads)
+{
+  struct saurion_config cfg;
+  saurion_config_default (&cfg);
+  cfg.n_threads = n_threads;
+  return saurion_create_ex (&cfg);
+}
+
+// saurion_create_ex
+[[nodiscard]]
+struct saurion *
+saurion_create_ex (const struct saurion_config *const cfg)
 {
   LOG_INIT (" ");
+  if (!cfg || cfg->ring_entries == 0 || cfg->chunk_sz < 16
+      || (cfg->send_high_water && cfg->send_low_water >= cfg->send_high_water)
+      || (cfg->send_global_high
+          && cfg->send_global_low >= cfg->send_global_high)
+      || cfg->slow_consumer > SAURION_SLOW_DISCONNECT
+      || cfg->buf_ring_entries > 32768
+      || (cfg->buf_ring_entries & (cfg->buf_ring_entries - 1)))
+    {
+      LOG_END (" ");
+      return NULL;
+    }
+  uint32_t n_threads = cfg->n_threads;
+  n_threads = (n_threads < 2 ? 2 : n_threads);
+  n_threads = (n_threads > NUM_CORES ? NUM_CORES : n_threads);
   struct saurion *p = (struct saurion *)malloc (sizeof (struct saurion));
   if (!p)
     {
       LOG_END (" ");
       return NULL;
     }
+  p->config = *cfg;
+  p->config.n_threads = n_threads;
   int ret = 0;
   ret = pthread_mutex_init (&p->status_m, NULL);
   if (ret)
@@ -848,6 +3163,20 @@ saurion_create (uint32_t n_threads)
       return NULL;
     }
   ret = pthread_cond_init (&p->status_c, NULL);
+  if (ret)
+    {
+      free (p);
+      LOG_END (" ");
+      return NULL;
+    }
+  ret = pthread_mutex_init (&p->drain_m, NULL);
+  if (ret)
+    {
+      free (p);
+      LOG_END (" ");
+      return NULL;
+    }
+  ret = pthread_cond_init (&p->drain_c, NULL);
   if (ret)
     {
       free (p);
@@ -867,17 +3196,48 @@ saurion_create (uint32_t n_threads)
       pthread_mutex_init (&(p->m_rings[i]), NULL);
     }
   p->ss = 0;
-  n_threads = (n_threads < 2 ? 2 : n_threads);
-  n_threads = (n_threads > NUM_CORES ? NUM_CORES : n_threads);
   p->n_threads = n_threads;
   p->status = 0;
-  p->list = NULL;
+  p->tables = NULL;
+  p->slabs = NULL;
+  p->sends = NULL;
+  p->copies = NULL;
+  p->chunks = NULL;
+  p->fixed = NULL;
+  p->provided = NULL;
+  p->stats = NULL;
+  p->inboxes = NULL;
+  p->backlogs = NULL;
+  p->fd_ring = NULL;
+  p->outbound = NULL;
+  p->pending = 0;
+  p->pending_over = 0;
+  p->drain_waiters = 0;
+  p->inbound = NULL;
+  p->parked = NULL;
+  p->starved = NULL;
+  p->held_bytes = 0;
+  p->held_msgs = 0;
+  p->conns = NULL;
+  p->listeners = NULL;
   p->cb.on_connected = NULL;
   p->cb.on_connected_arg = NULL;
   p->cb.on_readed = NULL;
   p->cb.on_readed_arg = NULL;
+  p->cb.on_readv = NULL;
+  p->cb.on_readv_arg = NULL;
+  p->cb.on_read_begin = NULL;
+  p->cb.on_read_begin_arg = NULL;
+  p->cb.on_read_chunk = NULL;
+  p->cb.on_read_chunk_arg = NULL;
+  p->cb.on_read_end = NULL;
+  p->cb.on_read_end_arg = NULL;
   p->cb.on_wrote = NULL;
   p->cb.on_wrote_arg = NULL;
+  p->cb.on_sent = NULL;
+  p->cb.on_sent_arg = NULL;
+  p->cb.on_drain = NULL;
+  p->cb.on_drain_arg = NULL;
   p->cb.on_closed = NULL;
   p->cb.on_closed_arg = NULL;
   p->cb.on_error = NULL;
@@ -924,7 +3284,7 @@ saurion_create (uint32_t n_threads)
   for (uint32_t i = 0; i < p->n_threads; ++i)
     {
       memset (&p->rings[i], 0, sizeof (struct io_uring));
-      ret = io_uring_queue_init (SAURION_RING_SIZE, &p->rings[i], 0);
+      ret = init_ring (&p->rings[i], &p->config, i);
       if (ret)
         {
           for (uint32_t j = 0; j < p->n_threads; ++j)
@@ -939,100 +3299,549 @@ saurion_create (uint32_t n_threads)
           return NULL;
         }
     }
+  if (p->config.zc_threshold && !send_zc_supported (&p->rings[0]))
+    {
+      p->config.zc_threshold = 0;
+    }
+  p->tables = (struct handle_table **)malloc (sizeof (struct handle_table *)
+                                              * p->n_threads);
+  if (!p->tables)
+    {
+      for (uint32_t j = 0; j < p->n_threads; ++j)
+        {
+          io_uring_queue_exit (&p->rings[j]);
+          close (p->efds[j]);
+        }
+      free (p->efds);
+      free (p->rings);
+      free (p->m_rings);
+      free (p);
+      LOG_END (" ");
+      return NULL;
+    }
+  p->slabs = (struct slab **)malloc (sizeof (struct slab *) * p->n_threads);
+  p->sends = (struct slab **)malloc (sizeof (struct slab *) * p->n_threads);
+  p->copies = (struct slab **)malloc (sizeof (struct slab *) * p->n_threads);
+  p->chunks = (struct chunk_pool **)malloc (sizeof (struct chunk_pool *)
+                                            * p->n_threads);
+  p->fixed = (uint32_t *)malloc (sizeof (uint32_t) * p->n_threads);
+  p->provided = (struct provided_buffers **)malloc (
+      sizeof (struct provided_buffers *) * p->n_threads);
+  p->stats = (struct saurion_stats *)calloc (p->n_threads,
+                                             sizeof (struct saurion_stats));
+  p->inboxes = (struct inbox *)calloc (p->n_threads, sizeof (struct inbox));
+  for (uint32_t i = 0; p->inboxes && i < p->n_threads; ++i)
+    {
+      p->inboxes[i].efd = -1;
+    }
+  p->backlogs = (struct sqe_backlog *)calloc (p->n_threads,
+                                              sizeof (struct sqe_backlog));
+  for (uint32_t i = 0; p->backlogs && i < p->n_threads; ++i)
+    {
+      p->backlogs[i].resizable = 1;
+    }
+  struct rlimit nofile;
+  p->fd_ring_sz = FD_RING_MAX;
+  if (!getrlimit (RLIMIT_NOFILE, &nofile) && nofile.rlim_cur < FD_RING_MAX)
+    {
+      p->fd_ring_sz = (uint32_t)nofile.rlim_cur;
+    }
+  p->fd_ring = (uint32_t *)calloc (p->fd_ring_sz, sizeof (uint32_t));
+  p->outbound = (struct outbound *)calloc (p->fd_ring_sz,
+                                           sizeof (struct outbound));
+  p->inbound = (struct inbound *)calloc (p->fd_ring_sz,
+                                         sizeof (struct inbound));
+  p->parked = (int *)malloc (sizeof (int) * p->n_threads);
+  p->starved = (int *)malloc (sizeof (int) * p->n_threads);
+  for (uint32_t i = 0; p->parked && p->starved && i < p->n_threads; ++i)
+    {
+      p->parked[i] = -1;
+      p->starved[i] = -1;
+    }
+  p->conns = (uint32_t *)calloc (p->n_threads, sizeof (uint32_t));
+  if (!p->slabs || !p->sends || !p->copies || !p->chunks || !p->fixed || !p->provided
+      || !p->stats || !p->inboxes || !p->backlogs || !p->fd_ring
+      || !p->outbound || !p->inbound || !p->parked || !p->starved
+      || !p->conns)
+    {
+      for (uint32_t j = 0; j < p->n_threads; ++j)
+        {
+          io_uring_queue_exit (&p->rings[j]);
+          close (p->efds[j]);
+        }
+      free (p->conns);
+      free (p->starved);
+      free (p->parked);
+      free (p->inbound);
+      free (p->outbound);
+      free (p->fd_ring);
+      free (p->backlogs);
+      free (p->inboxes);
+      free (p->stats);
+      free (p->provided);
+      free (p->fixed);
+      free (p->chunks);
+      free (p->sends);
+      free (p->copies);
+      free (p->slabs);
+      free (p->tables);
+      free (p->efds);
+      free (p->rings);
+      free (p->m_rings);
+      free (p);
+      LOG_END (" ");
+      return NULL;
+    }
+  for (uint32_t i = 0; i < p->n_threads; ++i)
+    {
+      p->tables[i]
+          = handle_table_create (p->config.ring_entries, free_request);
+      p->chunks[i] = chunk_pool_create (
+          p->config.chunk_sz, CHUNK_POOL_REGION,
+          CHUNK_POOL_HUGEPAGES ? CHUNK_POOL_HUGETLB : 0);
+      p->slabs[i] = (p->chunks[i] ? request_slab_create (p->chunks[i],
+                                                         p->config.chunk_sz)
+                                  : NULL);
+      p->sends[i] = send_slab_create ();
+      p->copies[i] = copy_slab_create (p->config.chunk_sz);
+      if (!p->tables[i] || !p->chunks[i] || !p->slabs[i] || !p->sends[i]
+          || !p->copies[i]
+          || !inbox_init (&p->inboxes[i]))
+        {
+          for (uint32_t j = 0; j < p->n_threads; ++j)
+            {
+              inbox_fini (&p->inboxes[j]);
+              handle_table_destroy (j <= i ? p->tables[j] : NULL);
+              provided_destroy (&p->rings[j], p->chunks[j],
+                                j < i ? p->provided[j] : NULL);
+              request_slab_destroy (j <= i ? p->slabs[j] : NULL);
+              slab_destroy (j <= i ? p->sends[j] : NULL);
+              slab_destroy (j <= i ? p->copies[j] : NULL);
+              chunk_pool_destroy (j <= i ? p->chunks[j] : NULL);
+              io_uring_queue_exit (&p->rings[j]);
+              close (p->efds[j]);
+            }
+          free (p->conns);
+          free (p->starved);
+          free (p->parked);
+          free (p->inbound);
+          free (p->outbound);
+          free (p->fd_ring);
+          free (p->backlogs);
+          free (p->inboxes);
+          free (p->stats);
+          free (p->provided);
+          free (p->fixed);
+          free (p->chunks);
+          free (p->sends);
+          free (p->copies);
+          free (p->slabs);
+          free (p->tables);
+          free (p->efds);
+          free (p->rings);
+          free (p->m_rings);
+          free (p);
+          LOG_END (" ");
+          return NULL;
+        }
+      p->fixed[i] = register_chunks (&p->rings[i], p->chunks[i]);
+      p->provided[i]
+          = provided_create (&p->rings[i], p->chunks[i],
+                             p->config.buf_ring_entries,
+                             p->config.recv_multishot, p->config.chunk_sz);
+    }
   p->pool = threadpool_create (p->n_threads);
   LOG_END (" ");
   return p;
 }
 
+// handle_event_recv
+static inline void
+handle_event_recv (struct saurion *const s, struct request *const req,
+                   const int res, const uint32_t flags, const int sel)
+{
+  const uint16_t bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+  if (res > 0)
+    {
+      view_source (NULL, sel, bid);
+      handle_read (s, req, 0, sel);
+      view_source (NULL, 0, -1);
+      req->next_iov = 0;
+      req->next_offset = 0;
+    }
+  if ((flags & IORING_CQE_F_BUFFER) && !s->provided[sel]->held[bid])
+    {
+      provided_recycle (s, (uint32_t)sel, bid);
+    }
+  struct inbound *const in = inbound_of (s, req->client_socket, sel);
+  if (flags & IORING_CQE_F_MORE)
+    {
+      if (in && in->recv == req && !in->parked && read_blocked (s, in))
+        {
+          read_cancel (s, in, sel);
+        }
+      return;
+    }
+  if (res > 0 || res == -ENOBUFS || res == -ECANCELED)
+    {
+      if (in && in->recv == req && (in->parked || read_blocked (s, in)))
+        {
+          read_park (s, in, RECV_PARKED, sel);
+          return;
+        }
+      if (res == -ENOBUFS && in && in->recv == req
+          && provided_exhausted (s, (uint32_t)sel))
+        {
+          read_starve (s, in, RECV_STARVED, (uint32_t)sel);
+          return;
+        }
+      add_recv (s, req, sel);
+      return;
+    }
+  if (res == -EINVAL && !req->prev)
+    {
+      pthread_mutex_lock (&s->m_rings[sel]);
+      s->provided[sel]->multishot = 0;
+      pthread_mutex_unlock (&s->m_rings[sel]);
+      add_fd (s, req->client_socket, sel);
+      handle_table_delete (s->tables[sel], req->handle);
+      return;
+    }
+  if (res < 0)
+    {
+      handle_error (s, req);
+    }
+  read_abort (s, req);
+  handle_close (s, req);
+  handle_table_delete (s->tables[sel], req->handle);
+}
+
+// handle_event_body
+static inline void
+handle_event_body (struct saurion *const s, struct request *const req,
+                   const int res, const int sel)
+{
+  if (res < 1)
+    {
+      if (res < 0)
+        {
+          handle_error (s, req);
+        }
+      read_abort (s, req);
+      handle_close (s, req);
+      handle_table_delete (s->tables[sel], req->handle);
+      return;
+    }
+  if ((uint64_t)res <= req->prev_remain)
+    {
+      // Short read: the rest goes right after it.
+      req->prev_remain -= (uint64_t)res;
+      req->iov[0].iov_base = (uint8_t *)req->iov[0].iov_base + res;
+      req->iov[0].iov_len -= (uint64_t)res;
+      add_read_body (s, req, sel);
+      return;
+    }
+  const int fd = req->client_socket;
+  void *msg = req->prev;
+  req->prev = NULL;
+  if (((uint8_t *)msg)[req->prev_size] == 0)
+    {
+      view_source (NULL, sel, -1);
+      handle_message (s, fd, &msg, req->prev_size, NULL, 0);
+      view_source (NULL, 0, -1);
+    }
+  slab_free (msg);
+  handle_table_delete (s->tables[sel], req->handle);
+  read_rearm (s, fd);
+}
+
 // handle_event_read
 static inline void
 handle_event_read (const struct io_uring_cqe *const cqe,
-                   struct saurion *const s, struct request *req)
+                   struct saurion *const s, struct request *req,
+                   const int sel)
 {
-  if (cqe->res < 0)
+  const int res = cqe->res;
+  const uint32_t flags = cqe->flags;
+  const uint16_t bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+  if (req->event_type == EV_BDY)
+    {
+      handle_event_body (s, req, res, sel);
+      return;
+    }
+  if (flags & IORING_CQE_F_BUFFER)
+    {
+      provided_attach (s->provided[sel], req, bid, res);
+    }
+  if (req->event_type == EV_RCV)
+    {
+      handle_event_recv (s, req, res, flags, sel);
+      return;
+    }
+  if (res == -ENOBUFS)
+    {
+      const int fd = req->client_socket;
+      handle_table_delete (s->tables[sel], req->handle);
+      struct inbound *const in = inbound_of (s, fd, (uint32_t)sel);
+      if (in && provided_exhausted (s, (uint32_t)sel))
+        {
+          read_starve (s, in, READ_STARVED, (uint32_t)sel);
+          return;
+        }
+      read_rearm (s, fd);
+      return;
+    }
+  if (res < 0)
     {
       handle_error (s, req);
     }
-  if (cqe->res < 1)
+  if (res < 1)
     {
+      read_abort (s, req);
       handle_close (s, req);
     }
-  if (cqe->res > 0)
+  if (res > 0)
+    {
+      if (flags & IORING_CQE_F_BUFFER)
+        {
+          view_source (NULL, sel, bid);
+        }
+      else
+        {
+          request_trim (req, (uint64_t)res);
+          view_source (req, sel, -1);
+        }
+      handle_read (s, req, 1, sel);
+      view_source (NULL, 0, -1);
+    }
+  if ((flags & IORING_CQE_F_BUFFER) && !s->provided[sel]->held[bid])
+    {
+      provided_recycle (s, (uint32_t)sel, bid);
+    }
+  // Retained messages keep the request, and its buffers, until released.
+  if (!req->retained)
     {
-      handle_read (s, req);
+      handle_table_delete (s->tables[sel], req->handle);
     }
-  list_delete_node (&s->list, req);
 }
 
-// saurion_worker_master_loop_it
+// record_batch
+static inline void
+record_batch (struct saurion *const s, const uint32_t sel,
+              const uint32_t count, const int overflow)
+{
+  pthread_mutex_lock (&s->m_rings[sel]);
+  struct saurion_stats *st = &s->stats[sel];
+  ++st->wakeups;
+  st->cqes += count;
+  if (count > st->max_batch)
+    {
+      st->max_batch = count;
+    }
+  st->sq_full = s->backlogs[sel].sq_full;
+  st->sq_deferred = s->backlogs[sel].sq_deferred;
+  st->cq_overflow += (overflow ? 1 : 0);
+  st->cq_dropped = *s->rings[sel].cq.koverflow;
+  pthread_mutex_unlock (&s->m_rings[sel]);
+}
+
+// accept_error
 [[nodiscard]]
 static inline int
-saurion_worker_master_loop_it (struct saurion *const s,
-                               struct sockaddr_in *const client_addr,
-                               socklen_t *const client_addr_len)
+accept_error (struct saurion *const s, const struct io_uring_cqe *const cqe,
+              struct request *const req, const uint32_t sel,
+              struct acceptor *const acc)
 {
-  LOG_INIT (" ");
-  struct io_uring ring = s->rings[0];
-  struct io_uring_cqe *cqe = NULL;
-  int ret = io_uring_wait_cqe (&ring, &cqe);
-  if (ret < 0)
+  const int err = -cqe->res;
+  const int ls = (s->listeners ? s->listeners[sel] : s->ss);
+  if (s->cb.on_error)
     {
-      free (cqe);
-      LOG_END (" ");
+      const char *resp = strerror (err);
+      s->cb.on_error (ls, resp, (int64_t)strlen (resp), s->cb.on_error_arg);
+    }
+  if (cqe->flags & IORING_CQE_F_MORE)
+    {
+      return SUCCESS_CODE;
+    }
+  handle_table_delete (s->tables[sel], req->handle);
+  switch (err)
+    {
+    case EBADF:
+    case ENOTSOCK:
+    case EINVAL:
+    case EOPNOTSUPP:
+    case ECANCELED:
+      // The listener itself is gone or unusable.
       return CRITICAL_CODE;
+    case EMFILE:
+    case ENFILE:
+    case ENOBUFS:
+    case ENOMEM:
+      // The connection stays in the backlog, so accepting again right away
+      // would only fail again.
+      add_accept_retry (s, sel, acc);
+      return SUCCESS_CODE;
+    default:
+      // The peer gave up (ECONNABORTED) or similar: the next one may not.
+      add_accept (s, sel, &acc->addr, &acc->addr_len, acc->multishot);
+      return SUCCESS_CODE;
+    }
+}
+
+// saurion_worker_accept_cqe
+[[nodiscard]]
+static inline int
+saurion_worker_accept_cqe (struct saurion *const s,
+                           const struct io_uring_cqe *const cqe,
+                           struct request *const req, const uint32_t sel,
+                           struct acceptor *const acc)
+{
+  if (cqe->res == -EINVAL && acc->multishot)
+    {
+      handle_table_delete (s->tables[sel], req->handle);
+      acc->multishot = 0;
+      add_accept (s, sel, &acc->addr, &acc->addr_len, acc->multishot);
+      return SUCCESS_CODE;
+    }
+  if (cqe->res == -ETIME)
+    {
+      // The wait after running out of descriptors or memory is over.
+      handle_table_delete (s->tables[sel], req->handle);
+      add_accept (s, sel, &acc->addr, &acc->addr_len, acc->multishot);
+      return SUCCESS_CODE;
+    }
+  if (cqe->res < 0)
+    {
+      return accept_error (s, cqe, req, sel, acc);
+    }
+  // With one listener per ring the kernel already balanced the connection,
+  // so it stays on the ring that accepted it.
+  pin_ring (s, cqe->res, (s->listeners ? sel : pick_ring (s, cqe->res)));
+  handle_accept (s, cqe->res);
+  add_read (s, cqe->res);
+  if (!(cqe->flags & IORING_CQE_F_MORE))
+    {
+      add_accept (s, sel, &acc->addr, &acc->addr_len, acc->multishot);
+      handle_table_delete (s->tables[sel], req->handle);
     }
+  return SUCCESS_CODE;
+}
+
+// saurion_worker_master_cqe
+[[nodiscard]]
+static inline int
+saurion_worker_master_cqe (struct saurion *const s,
+                           const struct io_uring_cqe *const cqe,
+                           struct acceptor *const acc)
+{
   struct request *req = (struct request *)cqe->user_data;
   if (!req)
     {
-      io_uring_cqe_seen (&s->rings[0], cqe);
-      LOG_END (" ");
       return SUCCESS_CODE;
     }
-  if (cqe->res < 0)
+  if (req->event_type == EV_ACC)
     {
-      list_delete_node (&s->list, req);
-      LOG_END (" ");
-      return CRITICAL_CODE;
+      return saurion_worker_accept_cqe (s, cqe, req, 0, acc);
     }
   if (req->client_socket == s->efds[0])
     {
-      io_uring_cqe_seen (&s->rings[0], cqe);
-      list_delete_node (&s->list, req);
-      LOG_END (" ");
+      handle_table_delete (s->tables[0], req->handle);
       return ERROR_CODE;
     }
-  io_uring_cqe_seen (&s->rings[0], cqe);
   switch (req->event_type)
     {
-    case EV_ACC:
-      handle_accept (s, cqe->res);
-      add_accept (s, client_addr, client_addr_len);
-      add_read (s, cqe->res);
-      list_delete_node (&s->list, req);
+    case EV_WAI:
+      handle_table_delete (s->tables[0], req->handle);
+      add_wait (s, 0);
+      inbox_drain (s, 0);
       break;
     case EV_REA:
-      handle_event_read (cqe, s, req);
+    case EV_RCV:
+    case EV_BDY:
+      handle_event_read (cqe, s, req, 0);
       break;
     case EV_WRI:
-      handle_write (s, req->client_socket);
-      list_delete_node (&s->list, req);
+    case EV_SND:
+      handle_event_write (s, cqe, req, 0);
       break;
     }
-  LOG_END (" ");
   return SUCCESS_CODE;
 }
 
+// saurion_worker_master_loop_it
+[[nodiscard]]
+static inline int
+saurion_worker_master_loop_it (struct saurion *const s,
+                               struct acceptor *const acc)
+{
+  LOG_INIT (" ");
+  worker_flush (s);
+  struct io_uring *const ring = &s->rings[0];
+  struct io_uring_cqe *cqe = NULL;
+  int ret = io_uring_wait_cqe (ring, &cqe);
+  if (ret < 0)
+    {
+      LOG_END (" ");
+      return CRITICAL_CODE;
+    }
+  const int overflow = io_uring_cq_has_overflow (ring);
+  unsigned head = 0;
+  uint32_t count = 0;
+  ret = SUCCESS_CODE;
+  io_uring_for_each_cqe (ring, head, cqe)
+  {
+    ++count;
+    ret = saurion_worker_master_cqe (s, cqe, acc);
+    if (ret != SUCCESS_CODE)
+      {
+        break;
+      }
+  }
+  io_uring_cq_advance (ring, count);
+  record_batch (s, 0, count, overflow);
+  LOG_END (" ");
+  return ret;
+}
+
+// worker_attach
+static inline void
+worker_attach (struct saurion *const s, const uint32_t sel)
+{
+  worker_of = s;
+  worker_sel = sel;
+  // Rings other than its own the worker prepared operations on.
+  worker_dirty = (uint64_t *)calloc ((s->n_threads + 63) / 64,
+                                     sizeof (uint64_t));
+  // Writes run in the worker that submitted them, so a write to a peer
+  // that is gone fails with EPIPE instead of killing the process.
+  sigset_t mask;
+  sigemptyset (&mask);
+  sigaddset (&mask, SIGPIPE);
+  pthread_sigmask (SIG_BLOCK, &mask, NULL);
+  if (s->config.single_issuer)
+    {
+      // The first thread enabling a single issuer ring becomes its only
+      // submitter, and only that thread may use the registered ring fd.
+      io_uring_enable_rings (&s->rings[sel]);
+      io_uring_register_ring_fd (&s->rings[sel]);
+    }
+  add_wait (s, sel);
+}
+
 // saurion_worker_master
 void
 saurion_worker_master (void *const arg)
 {
   LOG_INIT (" ");
   struct saurion *const s = (struct saurion *const)arg;
-  struct sockaddr_in client_addr;
-  socklen_t client_addr_len = sizeof (client_addr);
+  struct acceptor acc;
+  acc.addr_len = sizeof (acc.addr);
+  acc.multishot = 1;
 
+  worker_attach (s, 0);
   add_efd (s, s->efds[0], 0);
-  add_accept (s, &client_addr, &client_addr_len);
+  add_accept (s, 0, &acc.addr, &acc.addr_len, acc.multishot);
+  flush_ring (s, 0);
 
   pthread_mutex_lock (&s->status_m);
   ++s->status;
@@ -1040,13 +3849,15 @@ saurion_worker_master (void *const arg)
   pthread_mutex_unlock (&s->status_m);
   while (1)
     {
-      int ret
-          = saurion_worker_master_loop_it (s, &client_addr, &client_addr_len);
+      int ret = saurion_worker_master_loop_it (s, &acc);
       if (ret == ERROR_CODE || ret == CRITICAL_CODE)
         {
           break;
         }
     }
+  worker_of = NULL;
+  free (worker_dirty);
+  worker_dirty = NULL;
   pthread_mutex_lock (&s->status_m);
   --s->status;
   pthread_cond_signal (&s->status_c);
@@ -1055,58 +3866,82 @@ saurion_worker_master (void *const arg)
   return;
 }
 
-// saurion_worker_slave_loop_it
+// saurion_worker_slave_cqe
 [[nodiscard]]
 static inline int
-saurion_worker_slave_loop_it (struct saurion *const s, const int sel)
+saurion_worker_slave_cqe (struct saurion *const s,
+                          const struct io_uring_cqe *const cqe, const int sel,
+                          struct acceptor *const acc)
 {
-  LOG_INIT (" ");
-  struct io_uring ring = s->rings[sel];
-  struct io_uring_cqe *cqe = NULL;
-
-  add_efd (s, s->efds[sel], sel);
-  int ret = io_uring_wait_cqe (&ring, &cqe);
-  if (ret < 0)
-    {
-      free (cqe);
-      LOG_END (" ");
-      return CRITICAL_CODE;
-    }
   struct request *req = (struct request *)cqe->user_data;
   if (!req)
     {
-      io_uring_cqe_seen (&ring, cqe);
-      LOG_END (" ");
       return SUCCESS_CODE;
     }
-  if (cqe->res < 0)
+  if (req->event_type == EV_ACC)
     {
-      list_delete_node (&s->list, req);
-      LOG_END (" ");
-      return CRITICAL_CODE;
+      return saurion_worker_accept_cqe (s, cqe, req, sel, acc);
     }
   if (req->client_socket == s->efds[sel])
     {
-      io_uring_cqe_seen (&ring, cqe);
-      list_delete_node (&s->list, req);
-      LOG_END (" ");
+      handle_table_delete (s->tables[sel], req->handle);
       return ERROR_CODE;
     }
-  io_uring_cqe_seen (&ring, cqe);
   switch (req->event_type)
     {
+    case EV_WAI:
+      handle_table_delete (s->tables[sel], req->handle);
+      add_wait (s, sel);
+      inbox_drain (s, sel);
+      break;
     case EV_REA:
-      handle_event_read (cqe, s, req);
+    case EV_RCV:
+    case EV_BDY:
+      handle_event_read (cqe, s, req, sel);
       break;
     case EV_WRI:
-      handle_write (s, req->client_socket);
-      list_delete_node (&s->list, req);
+    case EV_SND:
+      handle_event_write (s, cqe, req, sel);
       break;
     }
-  LOG_END (" ");
   return SUCCESS_CODE;
 }
 
+// saurion_worker_slave_loop_it
+[[nodiscard]]
+static inline int
+saurion_worker_slave_loop_it (struct saurion *const s, const int sel,
+                              struct acceptor *const acc)
+{
+  LOG_INIT (" ");
+  worker_flush (s);
+  struct io_uring *const ring = &s->rings[sel];
+  struct io_uring_cqe *cqe = NULL;
+  int ret = io_uring_wait_cqe (ring, &cqe);
+  if (ret < 0)
+    {
+      LOG_END (" ");
+      return CRITICAL_CODE;
+    }
+  const int overflow = io_uring_cq_has_overflow (ring);
+  unsigned head = 0;
+  uint32_t count = 0;
+  ret = SUCCESS_CODE;
+  io_uring_for_each_cqe (ring, head, cqe)
+  {
+    ++count;
+    ret = saurion_worker_slave_cqe (s, cqe, sel, acc);
+    if (ret != SUCCESS_CODE)
+      {
+        break;
+      }
+  }
+  io_uring_cq_advance (ring, count);
+  record_batch (s, sel, count, overflow);
+  LOG_END (" ");
+  return ret;
+}
+
 // saurion_worker_slave
 void
 saurion_worker_slave (void *const arg)
@@ -1116,8 +3951,17 @@ saurion_worker_slave (void *const arg)
   struct saurion *s = ss->s;
   const int sel = ss->sel;
   free (ss);
+  struct acceptor acc;
+  acc.addr_len = sizeof (acc.addr);
+  acc.multishot = 1;
 
+  worker_attach (s, sel);
   add_efd (s, s->efds[sel], sel);
+  if (s->listeners)
+    {
+      add_accept (s, sel, &acc.addr, &acc.addr_len, acc.multishot);
+    }
+  flush_ring (s, sel);
 
   pthread_mutex_lock (&s->status_m);
   ++s->status;
@@ -1125,12 +3969,15 @@ saurion_worker_slave (void *const arg)
   pthread_mutex_unlock (&s->status_m);
   while (1)
     {
-      int res = saurion_worker_slave_loop_it (s, sel);
+      int res = saurion_worker_slave_loop_it (s, sel, &acc);
       if (res == ERROR_CODE || res == CRITICAL_CODE)
         {
           break;
         }
     }
+  worker_of = NULL;
+  free (worker_dirty);
+  worker_dirty = NULL;
   pthread_mutex_lock (&s->status_m);
   --s->status;
   pthread_cond_signal (&s->status_c);
@@ -1195,11 +4042,38 @@ saurion_destroy (struct saurion *const s)
   threadpool_destroy (s->pool);
   for (uint32_t i = 0; i < s->n_threads; ++i)
     {
+      inbox_fini (&s->inboxes[i]);
+      free (s->backlogs[i].sqes);
+      handle_table_destroy (s->tables[i]);
+      provided_destroy (&s->rings[i], s->chunks[i], s->provided[i]);
       io_uring_queue_exit (&s->rings[i]);
       pthread_mutex_destroy (&s->m_rings[i]);
+      request_slab_destroy (s->slabs[i]);
+      slab_destroy (s->sends[i]);
+      slab_destroy (s->copies[i]);
+      chunk_pool_destroy (s->chunks[i]);
     }
   free (s->m_rings);
-  list_free (&s->list);
+  free (s->tables);
+  free (s->slabs);
+  free (s->sends);
+  free (s->copies);
+  free (s->chunks);
+  free (s->fixed);
+  free (s->provided);
+  free (s->stats);
+  free (s->backlogs);
+  free (s->inboxes);
+  for (uint32_t i = 0; i < s->fd_ring_sz; ++i)
+    {
+      free (s->outbound[i].iov);
+    }
+  free (s->outbound);
+  free (s->inbound);
+  free (s->starved);
+  free (s->parked);
+  free (s->fd_ring);
+  free (s->conns);
   for (uint32_t i = 0; i < s->n_threads; ++i)
     {
       close (s->efds[i]);
@@ -1209,15 +4083,235 @@ saurion_destroy (struct saurion *const s)
     {
       close (s->ss);
     }
+  for (uint32_t i = 1; s->listeners && i < s->n_threads; ++i)
+    {
+      close (s->listeners[i]);
+    }
+  free (s->listeners);
   free (s->rings);
   pthread_mutex_destroy (&s->status_m);
   pthread_cond_destroy (&s->status_c);
+  pthread_mutex_destroy (&s->drain_m);
+  pthread_cond_destroy (&s->drain_c);
   free (s);
 }
 
+// send_msg
+static inline void
+send_msg (struct saurion *const s, const int fd, const char *const msg)
+{
+  const uint32_t sel = ring_of (s, fd);
+  if (owns_ring (s, sel))
+    {
+      add_write (s, fd, msg, sel);
+      return;
+    }
+  inbox_post (s, sel, EV_WRI, fd, msg);
+}
+
 // saurion_send
 void
 saurion_send (struct saurion *const s, const int fd, const char *const msg)
 {
-  add_write (s, fd, msg, next (s));
+  if (send_admit (s, fd, strlen (msg) + sizeof (uint64_t) + 1))
+    {
+      send_msg (s, fd, msg);
+    }
+}
+
+// saurion_try_send
+[[nodiscard]]
+int
+saurion_try_send (struct saurion *const s, const int fd, const char *const msg)
+{
+  if (send_closing (s, fd))
+    {
+      return EPIPE;
+    }
+  const uint32_t over = send_over (s, fd);
+  if (over && send_refuse (s, fd, over))
+    {
+      return EAGAIN;
+    }
+  send_reserve (s, fd, strlen (msg) + sizeof (uint64_t) + 1);
+  send_msg (s, fd, msg);
+  return 0;
+}
+
+// saurion_send_buf
+void
+saurion_send_buf (struct saurion *const s, const int fd, const void *const buf,
+                  const size_t len, void *const token)
+{
+  if (!send_admit (s, fd, len + sizeof (uint64_t) + 1))
+    {
+      if (s->cb.on_sent)
+        {
+          s->cb.on_sent (fd, token, -ENOBUFS, s->cb.on_sent_arg);
+        }
+      return;
+    }
+  const uint32_t sel = ring_of (s, fd);
+  if (owns_ring (s, sel))
+    {
+      add_write_buf (s, fd, buf, len, token, sel);
+      return;
+    }
+  struct inbox_msg *m = NULL;
+  while (!(m = (struct inbox_msg *)slab_alloc (s->copies[sel],
+                                               sizeof (struct inbox_msg))))
+    {
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  m->next = NULL;
+  m->event_type = EV_SND;
+  m->fd = fd;
+  m->ptr = (void *)buf;
+  m->len = len;
+  m->token = token;
+  inbox_push (s, sel, m);
+}
+
+// saurion_pause_read
+void
+saurion_pause_read (struct saurion *const s, const int fd)
+{
+  const uint32_t sel = ring_of (s, fd);
+  if (owns_ring (s, sel))
+    {
+      read_pause (s, fd, sel);
+      return;
+    }
+  inbox_post (s, sel, EV_PAU, fd, NULL);
+}
+
+// saurion_resume_read
+void
+saurion_resume_read (struct saurion *const s, const int fd)
+{
+  const uint32_t sel = ring_of (s, fd);
+  if (owns_ring (s, sel))
+    {
+      read_unpause (s, fd, sel);
+      return;
+    }
+  inbox_post (s, sel, EV_RES, fd, NULL);
+}
+
+// saurion_retain
+[[nodiscard]]
+struct saurion_lease *
+saurion_retain (struct saurion *const s)
+{
+  if (worker_of != s || !worker_view.active)
+    {
+      return NULL;
+    }
+  struct saurion_lease *l = worker_view.lease;
+  if (l)
+    {
+      __atomic_add_fetch (&l->refs, 1, __ATOMIC_RELAXED);
+      return l;
+    }
+  l = (struct saurion_lease *)malloc (sizeof (struct saurion_lease));
+  if (!l)
+    {
+      return NULL;
+    }
+  l->refs = 1;
+  l->sel = worker_view.sel;
+  l->bid = -1;
+  l->req = NULL;
+  l->heap = worker_view.heap;
+  l->fd = worker_view.fd;
+  l->len = worker_view.len;
+  read_hold (s, l->fd, l->len);
+  if (l->heap)
+    {
+      worker_view.heap = NULL;
+    }
+  else if (worker_view.bid >= 0)
+    {
+      l->bid = worker_view.bid;
+      struct provided_buffers *const pb = s->provided[l->sel];
+      if (!pb->held[l->bid]++)
+        {
+          ++pb->held_bids;
+        }
+    }
+  else
+    {
+      l->req = worker_view.req;
+      ++l->req->retained;
+    }
+  worker_view.lease = l;
+  return l;
+}
+
+// saurion_release
+void
+saurion_release (struct saurion *const s, struct saurion_lease *const l)
+{
+  if (!l || __atomic_sub_fetch (&l->refs, 1, __ATOMIC_ACQ_REL))
+    {
+      return;
+    }
+  if (l->heap)
+    {
+      if (l == worker_view.lease)
+        {
+          worker_view.lease = NULL;
+        }
+      read_unhold (s, l->fd, l->len);
+      slab_free (l->heap);
+      free (l);
+      return;
+    }
+  if (owns_ring (s, l->sel))
+    {
+      lease_drop (s, l);
+      return;
+    }
+  struct inbox_msg *m = NULL;
+  while (!(m = (struct inbox_msg *)slab_alloc (s->copies[l->sel],
+                                               sizeof (struct inbox_msg))))
+    {
+      nanosleep (&TIMEOUT_RETRY_SPEC, NULL);
+    }
+  m->event_type = EV_REL;
+  m->fd = -1;
+  m->ptr = l;
+  inbox_push (s, l->sel, m);
+}
+
+// saurion_get_stats
+void
+saurion_get_stats (struct saurion *const s, struct saurion_stats *stats)
+{
+  memset (stats, 0, sizeof (struct saurion_stats));
+  for (uint32_t i = 0; i < s->n_threads; ++i)
+    {
+      pthread_mutex_lock (&s->m_rings[i]);
+      stats->wakeups += s->stats[i].wakeups;
+      stats->cqes += s->stats[i].cqes;
+      stats->sq_full += s->stats[i].sq_full;
+      stats->sq_deferred += s->stats[i].sq_deferred;
+      stats->cq_overflow += s->stats[i].cq_overflow;
+      stats->cq_dropped += s->stats[i].cq_dropped;
+      stats->zc_sends += s->stats[i].zc_sends;
+      stats->zc_copied += s->stats[i].zc_copied;
+      stats->short_writes += s->stats[i].short_writes;
+      stats->coalesced += s->stats[i].coalesced;
+      stats->over_limit += s->stats[i].over_limit;
+      stats->read_pauses += s->stats[i].read_pauses;
+      stats->oversized += s->stats[i].oversized;
+      stats->body_reads += s->stats[i].body_reads;
+      stats->recv_arms += s->stats[i].recv_arms;
+      stats->buf_starved += s->stats[i].buf_starved;
+      if (s->stats[i].max_batch > stats->max_batch)
+        {
+          stats->max_batch = s->stats[i].max_batch;
+        }
+      pthread_mutex_unlock (&s->m_rings[i]);
+    }
 }
@@ -4,12 +4,22 @@
 #include <stdexcept> // for runtime_error
 #include <unistd.h>  // close
 
-Saurion::Saurion (const uint32_t thds, const int sck) noexcept
+Saurion::Saurion (const uint32_t thds, const int sck)
 {
   this->s = saurion_create (thds);
   if (!this->s)
     {
-      return;
+      throw std::runtime_error ("Error on saurion create");
+    }
+  this->s->ss = sck;
+}
+
+Saurion::Saurion (const struct saurion_config &cfg, const int sck)
+{
+  this->s = saurion_create_ex (&cfg);
+  if (!this->s)
+    {
+      throw std::runtime_error ("Error on saurion create");
     }
   this->s->ss = sck;
 }
@@ -20,6 +30,21 @@ Saurion::~Saurion ()
   saurion_destroy (this->s);
 }
 
+void
+Saurion::set_sockets (const int port)
+{
+  if (this->s->ss > 0)
+    {
+      close (this->s->ss);
+    }
+  if (!saurion_set_sockets (this->s, port))
+    {
+      // Nothing left for the destructor to close.
+      this->s->ss = -1;
+      throw std::runtime_error ("Error on saurion set sockets");
+    }
+}
+
 void
 Saurion::init ()
 {
@@ -51,6 +76,38 @@ Saurion::on_readed (Saurion::ReadedCb ncb, void *arg) noexcept
   return this;
 }
 
+Saurion *
+Saurion::on_readv (Saurion::ReadvCb ncb, void *arg) noexcept
+{
+  s->cb.on_readv = ncb;
+  s->cb.on_readv_arg = arg;
+  return this;
+}
+
+Saurion *
+Saurion::on_read_begin (Saurion::ReadBeginCb ncb, void *arg) noexcept
+{
+  s->cb.on_read_begin = ncb;
+  s->cb.on_read_begin_arg = arg;
+  return this;
+}
+
+Saurion *
+Saurion::on_read_chunk (Saurion::ReadChunkCb ncb, void *arg) noexcept
+{
+  s->cb.on_read_chunk = ncb;
+  s->cb.on_read_chunk_arg = arg;
+  return this;
+}
+
+Saurion *
+Saurion::on_read_end (Saurion::ReadEndCb ncb, void *arg) noexcept
+{
+  s->cb.on_read_end = ncb;
+  s->cb.on_read_end_arg = arg;
+  return this;
+}
+
 Saurion *
 Saurion::on_wrote (Saurion::WroteCb ncb, void *arg) noexcept
 {
@@ -59,6 +116,22 @@ Saurion::on_wrote (Saurion::WroteCb ncb, void *arg) noexcept
   return this;
 }
 
+Saurion *
+Saurion::on_sent (Saurion::SentCb ncb, void *arg) noexcept
+{
+  s->cb.on_sent = ncb;
+  s->cb.on_sent_arg = arg;
+  return this;
+}
+
+Saurion *
+Saurion::on_drain (Saurion::DrainCb ncb, void *arg) noexcept
+{
+  s->cb.on_drain = ncb;
+  s->cb.on_drain_arg = arg;
+  return this;
+}
+
 Saurion *
 Saurion::on_closed (Saurion::ClosedCb ncb, void *arg) noexcept
 {
@@ -80,3 +153,40 @@ Saurion::send (const int fd, const char *const msg) noexcept
 {
   saurion_send (this->s, fd, msg);
 }
+
+void
+Saurion::send_buf (const int fd, const void *const buf, const size_t len,
+                   void *const token) noexcept
+{
+  saurion_send_buf (this->s, fd, buf, len, token);
+}
+
+int
+Saurion::try_send (const int fd, const char *const msg) noexcept
+{
+  return saurion_try_send (this->s, fd, msg);
+}
+
+void
+Saurion::pause_read (const int fd) noexcept
+{
+  saurion_pause_read (this->s, fd);
+}
+
+void
+Saurion::resume_read (const int fd) noexcept
+{
+  saurion_resume_read (this->s, fd);
+}
+
+struct saurion_lease *
+Saurion::retain () noexcept
+{
+  return saurion_retain (this->s);
+}
+
+void
+Saurion::release (struct saurion_lease *lease) noexcept
+{
+  saurion_release (this->s, lease);
+}
@@ -0,0 +1,233 @@
+#include "slab.h"
+#include "config.h" // for ERROR_CODE, SUCCESS_CODE
+
+#include <pthread.h> // for pthread_mutex_lock, pthread_mutex_unlock
+#include <stddef.h>  // for max_align_t
+#include <stdlib.h>  // for malloc, free
+
+#define OVERSIZE UINT32_MAX
+
+struct slab_hdr
+{
+  struct slab *owner;
+  struct slab_hdr *next;
+  uint64_t capacity;
+  uint32_t cls;
+};
+
+#define HDR_SZ                                                                \
+  ((sizeof (struct slab_hdr) + sizeof (max_align_t) - 1)                      \
+   & ~(sizeof (max_align_t) - 1))
+#define TO_OBJ(h) ((void *)((uint8_t *)(h) + HDR_SZ))
+#define TO_HDR(o) ((struct slab_hdr *)((uint8_t *)(o) - HDR_SZ))
+
+struct slab_class
+{
+  struct slab_hdr *free;
+  uint32_t cached;
+};
+
+struct slab
+{
+  struct slab_class *classes;
+  uint32_t n_classes;
+  uint32_t max_cached;
+  uint64_t header_sz;
+  uint64_t item_sz;
+  int (*init) (void *, uint64_t, void *);
+  void (*fini) (void *, void *);
+  void *arg;
+  uint64_t allocs;
+  uint64_t misses;
+  uint64_t cached;
+  pthread_mutex_t mutex;
+};
+
+// class_of
+static inline uint32_t
+class_of (const uint64_t items)
+{
+  uint32_t cls = 0;
+  while (((uint64_t)1 << cls) < items && cls < 63)
+    {
+      ++cls;
+    }
+  return cls;
+}
+
+// release
+static inline void
+release (struct slab *slab, struct slab_hdr *hdr)
+{
+  if (slab->fini)
+    {
+      slab->fini (TO_OBJ (hdr), slab->arg);
+    }
+  free (hdr);
+}
+
+// slab_create
+[[nodiscard]]
+struct slab *
+slab_create (uint64_t header_sz, uint64_t item_sz, uint32_t classes,
+             uint32_t max_cached, int (*init) (void *, uint64_t, void *),
+             void (*fini) (void *, void *), void *arg)
+{
+  struct slab *slab = (struct slab *)malloc (sizeof (struct slab));
+  if (!slab)
+    {
+      return NULL;
+    }
+  classes = (classes < 1 ? 1 : classes);
+  slab->classes
+      = (struct slab_class *)malloc (sizeof (struct slab_class) * classes);
+  if (!slab->classes)
+    {
+      free (slab);
+      return NULL;
+    }
+  if (pthread_mutex_init (&slab->mutex, NULL))
+    {
+      free (slab->classes);
+      free (slab);
+      return NULL;
+    }
+  for (uint32_t i = 0; i < classes; ++i)
+    {
+      slab->classes[i].free = NULL;
+      slab->classes[i].cached = 0;
+    }
+  slab->n_classes = classes;
+  slab->max_cached = max_cached;
+  slab->header_sz = header_sz;
+  slab->item_sz = item_sz;
+  slab->init = init;
+  slab->fini = fini;
+  slab->arg = arg;
+  slab->allocs = 0;
+  slab->misses = 0;
+  slab->cached = 0;
+  return slab;
+}
+
+// slab_alloc
+[[nodiscard]]
+void *
+slab_alloc (struct slab *slab, uint64_t items)
+{
+  uint32_t cls = class_of (items);
+  pthread_mutex_lock (&slab->mutex);
+  ++slab->allocs;
+  if (cls < slab->n_classes && slab->classes[cls].free)
+    {
+      struct slab_hdr *hdr = slab->classes[cls].free;
+      slab->classes[cls].free = hdr->next;
+      --slab->classes[cls].cached;
+      --slab->cached;
+      pthread_mutex_unlock (&slab->mutex);
+      hdr->next = NULL;
+      return TO_OBJ (hdr);
+    }
+  ++slab->misses;
+  pthread_mutex_unlock (&slab->mutex);
+
+  uint64_t capacity = (cls < slab->n_classes ? (uint64_t)1 << cls : items);
+  struct slab_hdr *hdr = (struct slab_hdr *)malloc (
+      HDR_SZ + slab->header_sz + slab->item_sz * capacity);
+  if (!hdr)
+    {
+      return NULL;
+    }
+  hdr->owner = slab;
+  hdr->next = NULL;
+  hdr->capacity = capacity;
+  hdr->cls = (cls < slab->n_classes ? cls : OVERSIZE);
+  if (slab->init && !slab->init (TO_OBJ (hdr), capacity, slab->arg))
+    {
+      free (hdr);
+      return NULL;
+    }
+  return TO_OBJ (hdr);
+}
+
+// slab_capacity
+[[nodiscard]]
+uint64_t
+slab_capacity (const void *obj)
+{
+  return TO_HDR (obj)->capacity;
+}
+
+// slab_free
+void
+slab_free (void *obj)
+{
+  if (!obj)
+    {
+      return;
+    }
+  struct slab_hdr *hdr = TO_HDR (obj);
+  struct slab *slab = hdr->owner;
+  if (hdr->cls != OVERSIZE)
+    {
+      pthread_mutex_lock (&slab->mutex);
+      struct slab_class *cls = &slab->classes[hdr->cls];
+      if (cls->cached < slab->max_cached)
+        {
+          hdr->next = cls->free;
+          cls->free = hdr;
+          ++cls->cached;
+          ++slab->cached;
+          pthread_mutex_unlock (&slab->mutex);
+          return;
+        }
+      pthread_mutex_unlock (&slab->mutex);
+    }
+  release (slab, hdr);
+}
+
+// slab_get_stats
+void
+slab_get_stats (struct slab *slab, struct slab_stats *stats)
+{
+  pthread_mutex_lock (&slab->mutex);
+  stats->allocs = slab->allocs;
+  stats->misses = slab->misses;
+  stats->cached = slab->cached;
+  pthread_mutex_unlock (&slab->mutex);
+}
+
+// slab_arg
+[[nodiscard]]
+void *
+slab_arg (const struct slab *slab)
+{
+  return slab->arg;
+}
+
+// slab_destroy
+void
+slab_destroy (struct slab *slab)
+{
+  if (!slab)
+    {
+      return;
+    }
+  pthread_mutex_lock (&slab->mutex);
+  for (uint32_t i = 0; i < slab->n_classes; ++i)
+    {
+      struct slab_hdr *hdr = slab->classes[i].free;
+      while (hdr)
+        {
+          struct slab_hdr *next = hdr->next;
+          release (slab, hdr);
+          hdr = next;
+        }
+      slab->classes[i].free = NULL;
+      slab->classes[i].cached = 0;
+    }
+  pthread_mutex_unlock (&slab->mutex);
+  pthread_mutex_destroy (&slab->mutex);
+  free (slab->classes);
+  free (slab);
+}
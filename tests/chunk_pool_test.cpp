@@ -0,0 +1,187 @@
+#include "chunk_pool.h"
+#include "config.h" // for CHUNK_SZ, SUCCESS_CODE
+#include "gtest/gtest.h"
+
+#include <cstring> // for memset
+#include <set>     // for set
+#include <thread>  // for jthread
+#include <vector>  // for vector
+
+constexpr uint32_t PER_REGION = 16;
+
+class ChunkPoolTest : public ::testing::Test
+{
+public:
+  struct chunk_pool *pool = nullptr;
+
+protected:
+  void
+  SetUp () override
+  {
+    pool = chunk_pool_create (CHUNK_SZ, PER_REGION, 0);
+    ASSERT_NE (pool, nullptr);
+  }
+
+  void
+  TearDown () override
+  {
+    chunk_pool_destroy (pool);
+    pool = nullptr;
+  }
+
+  struct chunk_pool_stats
+  stats ()
+  {
+    struct chunk_pool_stats st;
+    chunk_pool_get_stats (pool, &st);
+    return st;
+  }
+};
+
+TEST_F (ChunkPoolTest, mapsLazily)
+{
+  EXPECT_EQ (stats ().regions, 0UL);
+  EXPECT_EQ (stats ().capacity, 0UL);
+  void *chunk = chunk_pool_get (pool);
+  ASSERT_NE (chunk, nullptr);
+  EXPECT_EQ (stats ().regions, 1UL);
+  EXPECT_EQ (stats ().capacity, (uint64_t)PER_REGION);
+  chunk_pool_put (pool, chunk);
+}
+
+TEST_F (ChunkPoolTest, chunksAreDistinctAndWritable)
+{
+  std::set<void *> seen;
+  std::vector<void *> chunks;
+  for (uint32_t i = 0; i < PER_REGION * 3; ++i)
+    {
+      void *chunk = chunk_pool_get (pool);
+      ASSERT_NE (chunk, nullptr);
+      memset (chunk, (int)i, CHUNK_SZ);
+      EXPECT_TRUE (seen.insert (chunk).second);
+      chunks.push_back (chunk);
+    }
+  for (uint32_t i = 0; i < chunks.size (); ++i)
+    {
+      EXPECT_EQ (((uint8_t *)chunks[i])[CHUNK_SZ - 1], (uint8_t)i);
+      chunk_pool_put (pool, chunks[i]);
+    }
+  EXPECT_EQ (stats ().regions, 3UL);
+}
+
+TEST_F (ChunkPoolTest, reusesReleasedChunks)
+{
+  void *first = chunk_pool_get (pool);
+  chunk_pool_put (pool, first);
+  void *second = chunk_pool_get (pool);
+  EXPECT_EQ (first, second);
+  chunk_pool_put (pool, second);
+  EXPECT_EQ (stats ().regions, 1UL);
+}
+
+TEST_F (ChunkPoolTest, tracksUsageAndHighWater)
+{
+  std::vector<void *> chunks;
+  for (int i = 0; i < 10; ++i)
+    {
+      chunks.push_back (chunk_pool_get (pool));
+    }
+  EXPECT_EQ (stats ().in_use, 10UL);
+  EXPECT_EQ (stats ().high_water, 10UL);
+  for (int i = 0; i < 6; ++i)
+    {
+      chunk_pool_put (pool, chunks.back ());
+      chunks.pop_back ();
+    }
+  EXPECT_EQ (stats ().in_use, 4UL);
+  EXPECT_EQ (stats ().high_water, 10UL);
+  for (void *chunk : chunks)
+    {
+      chunk_pool_put (pool, chunk);
+    }
+  EXPECT_EQ (stats ().in_use, 0UL);
+}
+
+TEST_F (ChunkPoolTest, putNullIsIgnored)
+{
+  chunk_pool_put (pool, nullptr);
+  EXPECT_EQ (stats ().in_use, 0UL);
+}
+
+TEST_F (ChunkPoolTest, reserveMapsRegionsUpFront)
+{
+  ASSERT_EQ (chunk_pool_reserve (pool, 2), SUCCESS_CODE);
+  EXPECT_EQ (stats ().regions, 2UL);
+  EXPECT_EQ (stats ().in_use, 0UL);
+  ASSERT_EQ (chunk_pool_reserve (pool, 1), SUCCESS_CODE);
+  EXPECT_EQ (stats ().regions, 2UL);
+}
+
+TEST_F (ChunkPoolTest, listsRegionsAndLocatesChunks)
+{
+  ASSERT_EQ (chunk_pool_reserve (pool, 2), SUCCESS_CODE);
+  struct iovec iovs[4];
+  ASSERT_EQ (chunk_pool_regions (pool, iovs, 4), 2U);
+  EXPECT_EQ (chunk_pool_regions (pool, iovs, 1), 1U);
+  std::vector<void *> chunks;
+  for (uint32_t i = 0; i < PER_REGION * 2; ++i)
+    {
+      chunks.push_back (chunk_pool_get (pool));
+    }
+  EXPECT_EQ (stats ().regions, 2UL);
+  for (void *chunk : chunks)
+    {
+      int64_t idx = chunk_pool_region_of (pool, chunk);
+      ASSERT_GE (idx, 0);
+      auto *base = static_cast<uint8_t *> (iovs[idx].iov_base);
+      EXPECT_GE (static_cast<uint8_t *> (chunk), base);
+      EXPECT_LE (static_cast<uint8_t *> (chunk) + CHUNK_SZ,
+                 base + iovs[idx].iov_len);
+      chunk_pool_put (pool, chunk);
+    }
+  int local = 0;
+  EXPECT_EQ (chunk_pool_region_of (pool, &local), -1);
+}
+
+TEST (ChunkPoolHugeTest, fallsBackWithoutReservedHugePages)
+{
+  struct chunk_pool *pool
+      = chunk_pool_create (CHUNK_SZ, PER_REGION, CHUNK_POOL_HUGETLB);
+  ASSERT_NE (pool, nullptr);
+  void *chunk = chunk_pool_get (pool);
+  ASSERT_NE (chunk, nullptr);
+  memset (chunk, 0, CHUNK_SZ);
+  struct chunk_pool_stats st;
+  chunk_pool_get_stats (pool, &st);
+  EXPECT_EQ (st.regions, 1UL);
+  EXPECT_GE (st.capacity, (uint64_t)PER_REGION);
+  chunk_pool_put (pool, chunk);
+  chunk_pool_destroy (pool);
+}
+
+TEST_F (ChunkPoolTest, ConcurrentGetAndPut)
+{
+  constexpr int threads_n = 16;
+  constexpr int rounds = 1000;
+  std::vector<std::jthread> threads;
+  for (int i = 0; i < threads_n; ++i)
+    {
+      threads.emplace_back ([this] () {
+        for (int j = 0; j < rounds; ++j)
+          {
+            auto *chunk = static_cast<uint8_t *> (chunk_pool_get (pool));
+            ASSERT_NE (chunk, nullptr);
+            chunk[CHUNK_SZ - 1] = (uint8_t)j;
+            chunk_pool_put (pool, chunk);
+          }
+      });
+    }
+
+  for (auto &thread : threads)
+    {
+      thread.join ();
+    }
+
+  EXPECT_EQ (stats ().in_use, 0UL);
+  EXPECT_LE (stats ().high_water, (uint64_t)threads_n);
+}
@@ -135,16 +135,18 @@ extractMessage (const char *buffer, int64_t &offset, uint64_t bytes_read,
   return true;
 }
 
-void
+int64_t
 parseMessages (const char *buffer, int64_t bytes_read,
                std::ofstream &logStream)
 {
   int64_t offset = 0;
+  int64_t parsed = 0;
   while (offset < bytes_read
          && extractMessage (buffer, offset, bytes_read, logStream))
     {
-      // parseMessages
+      parsed = offset;
     }
+  return parsed;
 }
 
 std::string
@@ -223,7 +225,6 @@ createClient (int clientId, int port)
   memset (buffer, 0, 8192);
 
   std::vector<uint8_t> accumulatedBuffer;
-  int64_t total_len = 0;
 
   struct timespec ts;
   ts.tv_sec = 0;
@@ -232,7 +233,6 @@ createClient (int clientId, int port)
     {
       int dataAvailable = 3;
 
-      total_len = 0;
       while (dataAvailable > 0)
         {
           int64_t len = read (sockfd, buffer, sizeof (buffer));
@@ -242,7 +242,6 @@ createClient (int clientId, int port)
 
               accumulatedBuffer.insert (accumulatedBuffer.end (), buffer,
                                         buffer + len);
-              total_len += len;
               continue;
             }
           if ((len == 0)
@@ -258,11 +257,33 @@ createClient (int clientId, int port)
 
       if (!accumulatedBuffer.empty ())
         {
-          parseMessages ((char *)accumulatedBuffer.data (), total_len,
-                         logStream);
-
-          accumulatedBuffer.clear ();
+          // Frames written in several pieces may still be incomplete; keep
+          // their bytes for the next reads.
+          const int64_t parsed
+              = parseMessages ((char *)accumulatedBuffer.data (),
+                               (int64_t)accumulatedBuffer.size (), logStream);
+          accumulatedBuffer.erase (accumulatedBuffer.begin (),
+                                   accumulatedBuffer.begin () + parsed);
+        }
+    }
+  // Messages written right before the disconnection may still be on their
+  // way, so read until the socket stays idle for a while.
+  for (int idle = 0; idle < 20;)
+    {
+      int64_t len = read (sockfd, buffer, sizeof (buffer));
+      if (len <= 0)
+        {
+          nanosleep (&ts, nullptr);
+          ++idle;
+          continue;
         }
+      accumulatedBuffer.insert (accumulatedBuffer.end (), buffer, buffer + len);
+      idle = 0;
+    }
+  if (!accumulatedBuffer.empty ())
+    {
+      parseMessages ((char *)accumulatedBuffer.data (),
+                     (int64_t)accumulatedBuffer.size (), logStream);
     }
   logStream.close ();
   close (sockfd);
@@ -0,0 +1,87 @@
+#include "chunk_pool.h"         // for chunk_pool_create, chunk_pool_destroy
+#include "config.h"             // for CHUNK_SZ, CHUNK_POOL_REGION
+#include "handle_table.h"       // for handle_table_create, handle_table_...
+#include "low_saurion_secret.h" // for request, set_request, free_request
+
+#include <chrono>  // for steady_clock, duration_cast
+#include <cstdint> // for uint64_t
+#include <cstdio>  // for printf
+#include <cstring> // for memset
+#include <random>  // for mt19937, uniform_int_distribution
+#include <vector>  // for vector
+
+constexpr uint64_t ROUNDS = 1000000;
+
+// bench
+static double
+bench (const uint32_t live)
+{
+  // The same table, pool and slab every ring sets up.
+  struct handle_table *table = handle_table_create (live, free_request);
+  struct chunk_pool *pool = chunk_pool_create (CHUNK_SZ, CHUNK_POOL_REGION, 0);
+  struct slab *slab = (pool ? request_slab_create (pool, CHUNK_SZ) : nullptr);
+  if (!table || !pool || !slab)
+    {
+      handle_table_destroy (table);
+      request_slab_destroy (slab);
+      chunk_pool_destroy (pool);
+      return -1;
+    }
+  // One read pending per connection.
+  bool ok = true;
+  std::vector<struct request *> reqs (live, nullptr);
+  for (uint32_t i = 0; ok && i < live; ++i)
+    {
+      ok = set_request (&reqs[i], slab, table, CHUNK_SZ, CHUNK_SZ, nullptr,
+                        0);
+    }
+  // Completions arrive in no particular order; drawn beforehand so the
+  // generator stays out of the timing.
+  std::mt19937 gen (42);
+  std::uniform_int_distribution<uint32_t> dist (0, live - 1);
+  std::vector<uint32_t> order (ROUNDS);
+  for (uint64_t i = 0; i < ROUNDS; ++i)
+    {
+      order[i] = dist (gen);
+    }
+
+  // Every round is a read completing and the next one armed in its place:
+  // the request of the CQE is deleted from the table, which gives it back
+  // to the slab, and a new one is taken from the slab and inserted. Its
+  // buffer is filled first, as the kernel does before the CQE is reaped, so
+  // the timing is not about bringing a long idle buffer back into cache.
+  std::chrono::steady_clock::duration elapsed{};
+  for (uint64_t i = 0; ok && i < ROUNDS; ++i)
+    {
+      struct request *&req = reqs[order[i]];
+      memset (req->iov[0].iov_base, 'A', req->iov[0].iov_len);
+      auto start = std::chrono::steady_clock::now ();
+      handle_table_delete (table, req->handle);
+      req = nullptr;
+      ok = set_request (&req, slab, table, CHUNK_SZ, CHUNK_SZ, nullptr, 0);
+      elapsed += std::chrono::steady_clock::now () - start;
+    }
+
+  handle_table_destroy (table);
+  request_slab_destroy (slab);
+  chunk_pool_destroy (pool);
+  if (!ok)
+    {
+      return -1;
+    }
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds> (
+             elapsed)
+             .count ()
+         / ROUNDS;
+}
+
+int
+main ()
+{
+  printf ("%12s %16s\n", "connections", "ns/completion");
+  for (uint32_t live : { 100U, 1000U, 10000U, 100000U })
+    {
+      printf ("%12u %16.1f\n", live, bench (live));
+    }
+  return 0;
+}
@@ -0,0 +1,235 @@
+#include "config.h" // for SUCCESS_CODE, ERROR_CODE
+#include "handle_table.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstring> // for strcpy, strlen
+#include <thread>  // for jthread
+#include <vector>  // for vector
+
+constexpr int N_ITEMS = 100;
+
+static std::atomic<int> released (0);
+
+static void
+release_item (void *ptr)
+{
+  delete[] static_cast<char *> (ptr);
+  released++;
+}
+
+class HandleTableTest : public ::testing::Test
+{
+public:
+  struct handle_table *table = nullptr;
+
+protected:
+  void
+  SetUp () override
+  {
+    released = 0;
+    table = handle_table_create (4, release_item);
+    ASSERT_NE (table, nullptr);
+  }
+
+  void
+  TearDown () override
+  {
+    handle_table_destroy (table);
+    table = nullptr;
+  }
+
+  uint64_t
+  insert_item (const char *const str)
+  {
+    auto *ptr = new char[strlen (str) + 1];
+    strcpy (ptr, str);
+    uint64_t handle = handle_table_insert (table, ptr);
+    if (handle == HANDLE_INVALID)
+      {
+        delete[] ptr;
+      }
+    return handle;
+  }
+};
+
+TEST_F (HandleTableTest, insertItems)
+{
+  for (int i = 0; i < N_ITEMS; ++i)
+    {
+      EXPECT_NE (insert_item ("item 1"), HANDLE_INVALID);
+    }
+  EXPECT_EQ (handle_table_size (table), (uint32_t)N_ITEMS);
+}
+
+TEST_F (HandleTableTest, insertAndGetItems)
+{
+  uint64_t handle = insert_item ("item to get");
+  for (int i = 0; i < N_ITEMS; ++i)
+    {
+      insert_item ("item 1");
+    }
+  auto *ptr = static_cast<char *> (handle_table_get (table, handle));
+  ASSERT_NE (ptr, nullptr);
+  EXPECT_STREQ (ptr, "item to get");
+}
+
+TEST_F (HandleTableTest, insertAndDeleteItems)
+{
+  for (int i = 0; i < N_ITEMS; ++i)
+    {
+      insert_item ("item 1");
+    }
+  uint64_t handle = insert_item ("item to delete");
+  for (int i = 0; i < N_ITEMS; ++i)
+    {
+      insert_item ("item 1");
+    }
+  EXPECT_EQ (handle_table_delete (table, handle), SUCCESS_CODE);
+  EXPECT_EQ (released, 1);
+  EXPECT_EQ (handle_table_size (table), (uint32_t)(2 * N_ITEMS));
+  EXPECT_EQ (handle_table_get (table, handle), nullptr);
+}
+
+TEST_F (HandleTableTest, tryDeleteNotExistentItem)
+{
+  for (int i = 0; i < N_ITEMS; ++i)
+    {
+      insert_item ("item 1");
+    }
+  EXPECT_EQ (handle_table_delete (table, HANDLE_INVALID), ERROR_CODE);
+  EXPECT_EQ (handle_table_delete (table, ((uint64_t)1 << 32) | 100000),
+             ERROR_CODE);
+  EXPECT_EQ (released, 0);
+  EXPECT_EQ (handle_table_size (table), (uint32_t)N_ITEMS);
+}
+
+TEST_F (HandleTableTest, staleHandleDoesNotReachReusedSlot)
+{
+  uint64_t stale = insert_item ("first");
+  EXPECT_EQ (handle_table_delete (table, stale), SUCCESS_CODE);
+  uint64_t fresh = insert_item ("second");
+  EXPECT_NE (stale, fresh);
+  EXPECT_EQ (stale & 0xFFFFFFFFUL, fresh & 0xFFFFFFFFUL);
+  EXPECT_EQ (handle_table_get (table, stale), nullptr);
+  EXPECT_EQ (handle_table_delete (table, stale), ERROR_CODE);
+  auto *ptr = static_cast<char *> (handle_table_get (table, fresh));
+  ASSERT_NE (ptr, nullptr);
+  EXPECT_STREQ (ptr, "second");
+}
+
+TEST_F (HandleTableTest, destroyReleasesLiveItems)
+{
+  for (int i = 0; i < N_ITEMS; ++i)
+    {
+      insert_item ("item 1");
+    }
+  handle_table_destroy (table);
+  table = nullptr;
+  EXPECT_EQ (released, N_ITEMS);
+}
+
+constexpr int N_THREADS = 100;
+constexpr int ITEMS_PER_THREAD = 100;
+
+class HandleTableConcurrencyTest : public HandleTableTest
+{
+public:
+  void
+  concurrent_insert ()
+  {
+    for (int i = 0; i < ITEMS_PER_THREAD; ++i)
+      {
+        insert_item ("concurrent item");
+      }
+  }
+
+  void
+  concurrent_insert_and_delete ()
+  {
+    for (int i = 0; i < ITEMS_PER_THREAD; ++i)
+      {
+        uint64_t handle = insert_item ("to delete");
+        handle_table_delete (table, handle);
+      }
+  }
+};
+
+TEST_F (HandleTableConcurrencyTest, ConcurrentInsertItems)
+{
+  std::vector<std::jthread> threads;
+  for (int i = 0; i < N_THREADS; ++i)
+    {
+      threads.emplace_back (&HandleTableConcurrencyTest::concurrent_insert,
+                            this);
+    }
+
+  for (auto &thread : threads)
+    {
+      thread.join ();
+    }
+
+  EXPECT_EQ (handle_table_size (table),
+             (uint32_t)(N_THREADS * ITEMS_PER_THREAD));
+}
+
+TEST_F (HandleTableConcurrencyTest, ConcurrentInsertAndDeleteItems)
+{
+  std::vector<std::jthread> threads;
+  for (int i = 0; i < N_THREADS; ++i)
+    {
+      threads.emplace_back (
+          &HandleTableConcurrencyTest::concurrent_insert_and_delete, this);
+    }
+
+  for (auto &thread : threads)
+    {
+      thread.join ();
+    }
+
+  EXPECT_EQ (handle_table_size (table), 0U);
+  EXPECT_EQ (released, N_THREADS * ITEMS_PER_THREAD);
+}
+
+TEST_F (HandleTableConcurrencyTest, ConcurrentInsertAndDeleteDifferentItems)
+{
+  std::atomic deletions (0);
+  std::vector<std::jthread> threads;
+
+  auto insert_task = [this] () {
+    for (int i = 0; i < ITEMS_PER_THREAD; ++i)
+      {
+        insert_item ("inserted item");
+      }
+  };
+
+  auto delete_task = [this, &deletions] () {
+    for (int i = 0; i < ITEMS_PER_THREAD; ++i)
+      {
+        uint64_t handle = insert_item ("to delete");
+        if (handle_table_delete (table, handle) == SUCCESS_CODE)
+          {
+            deletions++;
+          }
+      }
+  };
+
+  for (int i = 0; i < N_THREADS / 2; ++i)
+    {
+      threads.emplace_back (insert_task);
+    }
+
+  for (int i = 0; i < N_THREADS / 2; ++i)
+    {
+      threads.emplace_back (delete_task);
+    }
+
+  for (auto &thread : threads)
+    {
+      thread.join ();
+    }
+
+  EXPECT_EQ (deletions, (N_THREADS / 2) * ITEMS_PER_THREAD);
+  EXPECT_EQ (handle_table_size (table),
+             (uint32_t)((N_THREADS / 2) * ITEMS_PER_THREAD));
+}
@@ -0,0 +1,141 @@
+#include "low_saurion.h"
+
+#include <arpa/inet.h>    // for htons, inet_pton
+#include <chrono>         // for steady_clock, duration_cast
+#include <cstdint>        // for uint64_t
+#include <cstdio>         // for printf
+#include <cstring>        // for memcpy, memset
+#include <endian.h>       // for htobe64
+#include <netinet/in.h>   // for sockaddr_in
+#include <sys/resource.h> // for getrusage, rusage
+#include <sys/socket.h>   // for socket, connect
+#include <thread>         // for thread
+#include <unistd.h>       // for read, write, close
+#include <vector>         // for vector
+
+constexpr uint32_t CLIENTS = 8;
+constexpr uint64_t ROUNDS = 20000;
+constexpr int PORT = 18099;
+constexpr char MSG[] = "ping";
+
+// on_readed
+static void
+on_readed (const int fd, const void *const, const int64_t, void *arg)
+{
+  saurion_send ((struct saurion *)arg, fd, MSG);
+}
+
+// frame
+static std::vector<uint8_t>
+frame ()
+{
+  const uint64_t len = sizeof (MSG) - 1;
+  std::vector<uint8_t> buf (sizeof (uint64_t) + len + 1, 0);
+  const uint64_t be = htobe64 (len);
+  memcpy (buf.data (), &be, sizeof (be));
+  memcpy (buf.data () + sizeof (be), MSG, len);
+  return buf;
+}
+
+// client
+static void
+client (const int port)
+{
+  const int fd = socket (AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (port);
+  inet_pton (AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect (fd, (struct sockaddr *)&addr, sizeof (addr)) < 0)
+    {
+      close (fd);
+      return;
+    }
+  const std::vector<uint8_t> ping = frame ();
+  std::vector<uint8_t> pong (ping.size ());
+  for (uint64_t i = 0; i < ROUNDS; ++i)
+    {
+      if (write (fd, ping.data (), ping.size ()) < 0)
+        {
+          break;
+        }
+      size_t got = 0;
+      while (got < pong.size ())
+        {
+          ssize_t r = read (fd, pong.data () + got, pong.size () - got);
+          if (r <= 0)
+            {
+              close (fd);
+              return;
+            }
+          got += (size_t)r;
+        }
+    }
+  close (fd);
+}
+
+// bench
+static void
+bench (const uint32_t single_issuer)
+{
+  struct saurion_config cfg;
+  saurion_config_default (&cfg);
+  cfg.single_issuer = single_issuer;
+  const int port = PORT + (int)single_issuer;
+  struct saurion *s = saurion_create_ex (&cfg);
+  if (!s)
+    {
+      printf ("%14s %14s\n", single_issuer ? "single_issuer" : "shared",
+              "unsupported");
+      return;
+    }
+  s->ss = saurion_set_socket (port);
+  s->cb.on_readed = on_readed;
+  s->cb.on_readed_arg = s;
+  if (!s->ss || !saurion_start (s))
+    {
+      saurion_destroy (s);
+      return;
+    }
+
+  struct rusage before;
+  struct rusage after;
+  getrusage (RUSAGE_SELF, &before);
+  auto start = std::chrono::steady_clock::now ();
+  std::vector<std::thread> clients;
+  for (uint32_t i = 0; i < CLIENTS; ++i)
+    {
+      clients.emplace_back (client, port);
+    }
+  for (auto &c : clients)
+    {
+      c.join ();
+    }
+  auto end = std::chrono::steady_clock::now ();
+  getrusage (RUSAGE_SELF, &after);
+
+  saurion_stop (s);
+  close (s->ss);
+  saurion_destroy (s);
+
+  const double msgs = (double)CLIENTS * ROUNDS;
+  const double ns
+      = (double)std::chrono::duration_cast<std::chrono::nanoseconds> (end
+                                                                      - start)
+            .count ();
+  printf ("%14s %14.1f %14.1f %14.1f\n",
+          single_issuer ? "single_issuer" : "shared", ns / msgs,
+          (double)(after.ru_nvcsw - before.ru_nvcsw) * 1000 / msgs,
+          (double)(after.ru_nivcsw - before.ru_nivcsw) * 1000 / msgs);
+}
+
+int
+main ()
+{
+  printf ("%14s %14s %14s %14s\n", "rings", "ns/round-trip", "vcsw/1k msg",
+          "ivcsw/1k msg");
+  bench (0);
+  bench (1);
+  return 0;
+}
@@ -2,10 +2,24 @@
 #include "config.h"
 #include "low_saurion.h"
 #include "saurion.hpp"
+#include "slab.h"
 
-#include <cstring>     // for memset
-#include <memory>      // for allocator
-#include <stdatomic.h> // for atomicint
+#include <algorithm>    // for count, max
+#include <atomic>       // for atomic
+#include <arpa/inet.h>  // for htons, inet_pton
+#include <cstring>      // for memset
+#include <endian.h>     // for be64toh, htobe64
+#include <liburing.h>   // for IORING_SETUP_SQPOLL, IORING_SETUP_SINGLE_...
+#include <memory>       // for allocator
+#include <netinet/in.h> // for sockaddr_in
+#include <stdatomic.h>  // for atomicint
+#include <stdexcept>    // for runtime_error
+#include <string>       // for string
+#include <sys/resource.h> // for getrlimit, setrlimit
+#include <sys/socket.h> // for socket, connect
+#include <thread>       // for thread
+#include <unistd.h>     // for sysconf
+#include <vector>       // for vector
 
 #include "gtest/gtest.h"
 
@@ -30,6 +44,8 @@ struct summary
   uint32_t wrote = 0;
   pthread_cond_t wrote_c = PTHREAD_COND_INITIALIZER;
   pthread_mutex_t wrote_m = PTHREAD_MUTEX_INITIALIZER;
+  uint32_t errors = 0;
+  pthread_mutex_t errors_m = PTHREAD_MUTEX_INITIALIZER;
 } __attribute__ ((aligned (128)));
 
 // Callbacks
@@ -82,9 +98,12 @@ cb_OnClosed (int sfd, void *arg)
 }
 //    -> OnError
 static void
-cb_OnError (int, const char *const, const int64_t, void *)
+cb_OnError (int, const char *const, const int64_t, void *arg)
 {
-  // Not tested yet
+  auto *summary = static_cast<struct summary *> (arg);
+  pthread_mutex_lock (&summary->errors_m);
+  summary->errors++;
+  pthread_mutex_unlock (&summary->errors_m);
 }
 
 class CommonSaurion
@@ -168,19 +187,29 @@ private:
   struct saurion *saurion;
 
 public:
+  Saurion::ReadvCb readv = nullptr;
+  void *readv_arg = nullptr;
+  Saurion::SentCb sent = nullptr;
+  void *sent_arg = nullptr;
+  Saurion::DrainCb drained = nullptr;
+  void *drained_arg = nullptr;
+  Saurion::ReadBeginCb read_begin = nullptr;
+  Saurion::ReadChunkCb read_chunk = nullptr;
+  Saurion::ReadEndCb read_end = nullptr;
+  void *stream_arg = nullptr;
+
   // SetUp
   void
-  SetUp (const uint port)
+  SetUp (const uint port, const struct saurion_config *const cfg = nullptr)
   {
     CommonSaurion::SetUpCommon ();
     const unsigned int N_THREADS = 6;
-    saurion = saurion_create (N_THREADS);
+    saurion = (cfg ? saurion_create_ex (cfg) : saurion_create (N_THREADS));
     if (!saurion)
       {
         return;
       }
-    saurion->ss = saurion_set_socket (port);
-    if (!saurion->ss)
+    if (!saurion_set_sockets (saurion, port))
       {
         throw std::runtime_error (strerror (errno));
       }
@@ -188,8 +217,20 @@ public:
     saurion->cb.on_connected_arg = &summary;
     saurion->cb.on_readed = cb_OnReaded;
     saurion->cb.on_readed_arg = &summary;
+    saurion->cb.on_readv = readv;
+    saurion->cb.on_readv_arg = readv_arg;
     saurion->cb.on_wrote = cb_OnWrote;
     saurion->cb.on_wrote_arg = &summary;
+    saurion->cb.on_sent = sent;
+    saurion->cb.on_sent_arg = sent_arg;
+    saurion->cb.on_drain = drained;
+    saurion->cb.on_drain_arg = drained_arg;
+    saurion->cb.on_read_begin = read_begin;
+    saurion->cb.on_read_begin_arg = stream_arg;
+    saurion->cb.on_read_chunk = read_chunk;
+    saurion->cb.on_read_chunk_arg = stream_arg;
+    saurion->cb.on_read_end = read_end;
+    saurion->cb.on_read_end_arg = stream_arg;
     saurion->cb.on_closed = cb_OnClosed;
     saurion->cb.on_closed_arg = &summary;
     saurion->cb.on_error = cb_OnError;
@@ -220,6 +261,21 @@ public:
       }
   }
 
+  // send_buf
+  void
+  send_buf (const int sfd, const void *const buf, const size_t len,
+            void *const token)
+  {
+    saurion_send_buf (saurion, sfd, buf, len, token);
+  }
+
+  // try_send
+  [[nodiscard]] int
+  try_send (const int sfd, const char *const msg)
+  {
+    return saurion_try_send (saurion, sfd, msg);
+  }
+
   // sendAll
   void
   sendAll (const uint32_t n, const char *const msg)
@@ -232,6 +288,77 @@ public:
           }
       }
   }
+
+  // pause_read
+  void
+  pause_read (const int sfd)
+  {
+    saurion_pause_read (saurion, sfd);
+  }
+
+  // resume_read
+  void
+  resume_read (const int sfd)
+  {
+    saurion_resume_read (saurion, sfd);
+  }
+
+  // stats
+  struct saurion_stats
+  stats () const
+  {
+    struct saurion_stats st;
+    saurion_get_stats (saurion, &st);
+    return st;
+  }
+
+  // provided
+  bool
+  provided () const
+  {
+    return saurion->provided[0] != nullptr;
+  }
+
+  // zero_copy
+  bool
+  zero_copy () const
+  {
+    return saurion->config.zc_threshold != 0;
+  }
+
+  // retain
+  struct saurion_lease *
+  retain () const
+  {
+    return saurion_retain (saurion);
+  }
+
+  // release
+  void
+  release (struct saurion_lease *const lease) const
+  {
+    saurion_release (saurion, lease);
+  }
+
+  // ring_conns
+  std::vector<uint32_t>
+  ring_conns () const
+  {
+    return std::vector<uint32_t> (saurion->conns,
+                                  saurion->conns + saurion->n_threads);
+  }
+
+  // ring_flags
+  std::vector<uint32_t>
+  ring_flags () const
+  {
+    std::vector<uint32_t> flags;
+    for (uint32_t i = 0; i < saurion->n_threads; ++i)
+      {
+        flags.push_back (saurion->rings[i].flags);
+      }
+    return flags;
+  }
 };
 
 class HighSaurion : public CommonSaurion
@@ -242,11 +369,19 @@ private:
 public:
   // SetUp
   void
-  SetUp (const uint port)
+  SetUp (const uint port, const struct saurion_config *const cfg = nullptr)
   {
     CommonSaurion::SetUpCommon ();
     const unsigned int N_THREADS = 6;
-    saurion = new Saurion (N_THREADS, saurion_set_socket (port));
+    if (cfg)
+      {
+        saurion = new Saurion (*cfg, -1);
+        saurion->set_sockets ((int)port);
+      }
+    else
+      {
+        saurion = new Saurion (N_THREADS, saurion_set_socket (port));
+      }
     saurion->on_connected (cb_OnConnected, &summary)
         ->on_readed (cb_OnReaded, &summary)
         ->on_wrote (cb_OnWrote, &summary)
@@ -397,3 +532,1590 @@ TYPED_TEST (SaurionTest, handleConcurrentReadsAndWrites)
   this->client.disconnect ();
   this->saurion.wait_disconnected (clients);
 }
+
+TYPED_TEST (SaurionTest, manyPublishersSendConcurrently)
+{
+  uint32_t clients = 10;
+  uint32_t publishers = 32;
+  uint32_t msgs = 20;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  EXPECT_EQ (this->saurion.summary.connected, clients);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < publishers; ++i)
+    {
+      threads.emplace_back (
+          [this, msgs] () { this->saurion.sendAll (msgs, "Hola"); });
+    }
+  for (auto &thread : threads)
+    {
+      thread.join ();
+    }
+  this->saurion.wait_wrote (publishers * msgs * clients);
+  EXPECT_EQ (this->saurion.summary.wrote, publishers * msgs * clients);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+// The allocator entry points forward to glibc, counting the calls made while
+// a test enables it, by any thread of the process.
+extern "C"
+{
+  void *__libc_malloc (size_t size);
+  void *__libc_calloc (size_t n, size_t size);
+  void *__libc_realloc (void *ptr, size_t size);
+}
+
+static std::atomic<bool> count_allocs (false);
+static std::atomic<uint64_t> allocs (0);
+
+// malloc
+extern "C" void *
+malloc (size_t size) noexcept
+{
+  if (count_allocs.load (std::memory_order_relaxed))
+    {
+      allocs.fetch_add (1, std::memory_order_relaxed);
+    }
+  return __libc_malloc (size);
+}
+
+// calloc
+extern "C" void *
+calloc (size_t n, size_t size) noexcept
+{
+  if (count_allocs.load (std::memory_order_relaxed))
+    {
+      allocs.fetch_add (1, std::memory_order_relaxed);
+    }
+  return __libc_calloc (n, size);
+}
+
+// realloc
+extern "C" void *
+realloc (void *ptr, size_t size) noexcept
+{
+  if (count_allocs.load (std::memory_order_relaxed))
+    {
+      allocs.fetch_add (1, std::memory_order_relaxed);
+    }
+  return __libc_realloc (ptr, size);
+}
+
+class SaurionAllocTest : public SaurionTest<LowSaurion>
+{
+};
+
+TEST_F (SaurionAllocTest, steadyStateEchoDoesNotAllocate)
+{
+  uint32_t clients = 10;
+  uint32_t msgs = 100;
+  uint32_t rounds = 20;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  EXPECT_EQ (this->saurion.summary.connected, clients);
+  this->saurion.sendAll (msgs, "Hola");
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_readed (msgs * clients * 4);
+  this->saurion.wait_wrote (msgs * clients);
+  allocs = 0;
+  count_allocs = true;
+  for (uint32_t i = 1; i <= rounds; ++i)
+    {
+      this->client.send (1, "Hola", 0);
+      this->saurion.wait_readed ((msgs + i) * clients * 4);
+      this->saurion.sendAll (1, "Hola");
+      this->saurion.wait_wrote ((msgs + i) * clients);
+    }
+  count_allocs = false;
+  // Requests, message copies and messages posted to the workers all come
+  // from the per-ring slabs once warm.
+  EXPECT_EQ (allocs.load (), 0UL);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+  EXPECT_EQ (this->saurion.summary.disconnected, clients);
+}
+
+class SaurionStatsTest : public SaurionTest<LowSaurion>
+{
+};
+
+TEST_F (SaurionStatsTest, countsCompletionsPerWakeup)
+{
+  uint32_t clients = 10;
+  uint32_t msgs = 100;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  this->saurion.sendAll (msgs, "Hola");
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_readed (msgs * clients * 4);
+  this->saurion.wait_wrote (msgs * clients);
+  struct saurion_stats st = this->saurion.stats ();
+  // Every connection was at least accepted, read from and written to, but
+  // queued messages share writes.
+  EXPECT_GE (st.cqes, (uint64_t)(clients * 3));
+  EXPECT_GE (st.cqes, st.wakeups);
+  EXPECT_GE (st.max_batch, 1UL);
+  EXPECT_GT (st.wakeups, 0UL);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+class SaurionConfigTest : public SaurionTest<LowSaurion>
+{
+public:
+  static constexpr uint64_t SMALL_CHUNK = 256;
+
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 3;
+    cfg.ring_entries = 64;
+    cfg.cq_entries = 512;
+    cfg.chunk_sz = SMALL_CHUNK;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST (SaurionConfig, rejectsInvalidSettings)
+{
+  struct saurion_config cfg;
+  saurion_config_default (&cfg);
+  EXPECT_EQ (cfg.chunk_sz, (uint64_t)CHUNK_SZ);
+  EXPECT_EQ (cfg.ring_entries, (uint32_t)SAURION_RING_SIZE);
+  cfg.ring_entries = 0;
+  EXPECT_EQ (saurion_create_ex (&cfg), nullptr);
+  saurion_config_default (&cfg);
+  cfg.chunk_sz = 8;
+  EXPECT_EQ (saurion_create_ex (&cfg), nullptr);
+  saurion_config_default (&cfg);
+  cfg.buf_ring_entries = 48;
+  EXPECT_EQ (saurion_create_ex (&cfg), nullptr);
+  EXPECT_EQ (saurion_create_ex (nullptr), nullptr);
+}
+
+TEST (SaurionConfig, wrapperThrowsOnInvalidSettings)
+{
+  struct saurion_config cfg;
+  saurion_config_default (&cfg);
+  cfg.buf_ring_entries = 48;
+  EXPECT_THROW (Saurion (cfg, -1), std::runtime_error);
+  saurion_config_default (&cfg);
+  cfg.send_high_water = 1024;
+  cfg.send_low_water = 1024;
+  EXPECT_THROW (Saurion (cfg, -1), std::runtime_error);
+  saurion_config_default (&cfg);
+  cfg.slow_consumer = SAURION_SLOW_DISCONNECT + 1;
+  EXPECT_THROW (Saurion (cfg, -1), std::runtime_error);
+}
+
+TEST_F (SaurionConfigTest, splitsMessagesOverSmallChunks)
+{
+  uint32_t clients = 1;
+  uint32_t msgs = 10;
+  uint64_t size = SMALL_CHUNK * 4 + 17;
+  auto str = std::make_unique<char[]> (size + 1);
+  std::memset (str.get (), 'A', size);
+  str[size] = 0;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  EXPECT_EQ (this->saurion.summary.connected, clients);
+  this->client.send (1, str.get (), 0);
+  this->saurion.wait_readed (size);
+  EXPECT_EQ (this->saurion.summary.readed, size);
+  this->saurion.sendAll (msgs, str.get ());
+  this->saurion.wait_wrote (msgs * clients);
+  EXPECT_EQ (this->saurion.summary.wrote, msgs * clients);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+  EXPECT_EQ (this->saurion.summary.disconnected, clients);
+}
+
+class SaurionBacklogTest : public SaurionTest<LowSaurion>
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.ring_entries = 4;
+    cfg.cq_entries = 8;
+    // Every message has to re-arm a read, which a buffer ring's multishot
+    // receives would spare, for the queue to fill up.
+    cfg.buf_ring_entries = 0;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionBacklogTest, defersOperationsWhileTheQueueIsFull)
+{
+  // Messages to one connection share a write, so it takes more connections
+  // than submission queue entries to fill it.
+  uint32_t clients = 8;
+  uint32_t msgs = 50;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  this->saurion.sendAll (msgs, "Hola");
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_wrote (msgs * clients);
+  this->saurion.wait_readed (msgs * clients * 4);
+  EXPECT_EQ (this->saurion.summary.wrote, msgs * clients);
+  EXPECT_EQ (this->saurion.summary.readed, msgs * clients * 4);
+  struct saurion_stats st = this->saurion.stats ();
+  EXPECT_GT (st.sq_full, 0UL);
+  EXPECT_EQ (st.cq_dropped, 0UL);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+class SaurionViewTest : public SaurionTest<LowSaurion>
+{
+public:
+  struct kept
+  {
+    struct saurion_lease *lease;
+    std::vector<struct iovec> iov;
+  };
+
+  struct views
+  {
+    LowSaurion *saurion = nullptr;
+    pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+    std::vector<std::string> msgs;
+    std::vector<kept> leases;
+    bool retain = false;
+  };
+
+  // joined
+  static std::string
+  joined (const struct iovec *const iov, const uint32_t iovcnt)
+  {
+    std::string msg;
+    for (uint32_t i = 0; i < iovcnt; ++i)
+      {
+        msg.append ((const char *)iov[i].iov_base, iov[i].iov_len);
+      }
+    return msg;
+  }
+
+  // on_readv
+  static void
+  on_readv (const int fd, const struct iovec *const iov, const uint32_t iovcnt,
+            const int64_t len, void *arg)
+  {
+    auto *v = static_cast<views *> (arg);
+    pthread_mutex_lock (&v->m);
+    v->msgs.push_back (joined (iov, iovcnt));
+    if (v->retain)
+      {
+        v->leases.push_back (
+            { v->saurion->retain (), std::vector<struct iovec> (
+                                         iov, iov + iovcnt) });
+      }
+    pthread_mutex_unlock (&v->m);
+    cb_OnReaded (fd, nullptr, len, &v->saurion->summary);
+  }
+
+protected:
+  views v;
+  uint32_t buf_ring = 0;
+  uint32_t multishot = 0;
+
+  void
+  SetUp () override
+  {
+    v.saurion = &saurion;
+    saurion.readv = on_readv;
+    saurion.readv_arg = &v;
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 6;
+    cfg.buf_ring_entries = buf_ring;
+    cfg.recv_multishot = multishot;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionViewTest, deliversMessagesInPlace)
+{
+  uint32_t clients = 2;
+  uint32_t msgs = 20;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_readed (msgs * clients * 4);
+  EXPECT_EQ (this->saurion.summary.readed, msgs * clients * 4);
+  pthread_mutex_lock (&v.m);
+  EXPECT_EQ (v.msgs.size (), (size_t)(msgs * clients));
+  for (const std::string &msg : v.msgs)
+    {
+      EXPECT_EQ (msg, "Hola");
+    }
+  pthread_mutex_unlock (&v.m);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+TEST_F (SaurionViewTest, retainedViewsOutliveTheCallback)
+{
+  uint32_t clients = 1;
+  uint32_t msgs = 10;
+  v.retain = true;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_readed (msgs * 4);
+  pthread_mutex_lock (&v.m);
+  v.retain = false;
+  pthread_mutex_unlock (&v.m);
+  // New reads must not land on the retained buffers.
+  this->client.send (msgs, "Chau", 0);
+  this->saurion.wait_readed (msgs * 8);
+  pthread_mutex_lock (&v.m);
+  EXPECT_EQ (v.leases.size (), (size_t)msgs);
+  for (const kept &k : v.leases)
+    {
+      EXPECT_NE (k.lease, nullptr);
+      EXPECT_EQ (joined (k.iov.data (), (uint32_t)k.iov.size ()), "Hola");
+      this->saurion.release (k.lease);
+    }
+  v.leases.clear ();
+  pthread_mutex_unlock (&v.m);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+TEST_F (SaurionViewTest, gathersMessagesSpanningSeveralReads)
+{
+  std::string big (CHUNK_SZ * 3 + 5, '\0');
+  for (size_t i = 0; i < big.size (); ++i)
+    {
+      big[i] = (char)('A' + i % 26);
+    }
+  this->client.connect (1);
+  this->saurion.wait_connected (1);
+  this->client.send (2, big.c_str (), 0);
+  this->saurion.wait_readed (big.size () * 2);
+  pthread_mutex_lock (&v.m);
+  ASSERT_EQ (v.msgs.size (), 2UL);
+  EXPECT_EQ (v.msgs[0], big);
+  EXPECT_EQ (v.msgs[1], big);
+  pthread_mutex_unlock (&v.m);
+  // The rest of each message is read straight into its copy.
+  EXPECT_GE (this->saurion.stats ().body_reads, 2UL);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (1);
+}
+
+class SaurionBufRingTest : public SaurionViewTest
+{
+protected:
+  SaurionBufRingTest () { buf_ring = 64; }
+};
+
+TEST_F (SaurionBufRingTest, readsIntoProvidedBuffers)
+{
+  if (!this->saurion.provided ())
+    {
+      GTEST_SKIP () << "kernel without provided buffer rings";
+    }
+  std::string big (CHUNK_SZ * 3 + 5, '\0');
+  for (size_t i = 0; i < big.size (); ++i)
+    {
+      big[i] = (char)('a' + i % 26);
+    }
+  uint32_t clients = 2;
+  uint32_t msgs = 20;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_readed (msgs * clients * 4);
+  this->client.send (1, big.c_str (), 0);
+  this->saurion.wait_readed (msgs * clients * 4 + big.size () * clients);
+  pthread_mutex_lock (&v.m);
+  ASSERT_EQ (v.msgs.size (), (size_t)((msgs + 1) * clients));
+  for (size_t i = 0; i < v.msgs.size (); ++i)
+    {
+      EXPECT_EQ (v.msgs[i], i < msgs * clients ? std::string ("Hola") : big);
+    }
+  pthread_mutex_unlock (&v.m);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+// settle
+static void
+settle ()
+{
+  struct timespec tim;
+  tim.tv_sec = 0;
+  tim.tv_nsec = 50000000L;
+  nanosleep (&tim, nullptr);
+}
+
+class SaurionMultishotTest : public SaurionViewTest
+{
+protected:
+  SaurionMultishotTest ()
+  {
+    buf_ring = 64;
+    multishot = 1;
+  }
+};
+
+TEST_F (SaurionMultishotTest, deliversSeveralMessagesPerReceive)
+{
+  if (!this->saurion.provided ())
+    {
+      GTEST_SKIP () << "kernel without provided buffer rings";
+    }
+  uint32_t clients = 2;
+  uint32_t msgs = 20;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_readed (msgs * clients * 4);
+  pthread_mutex_lock (&v.m);
+  EXPECT_EQ (v.msgs.size (), (size_t)(msgs * clients));
+  pthread_mutex_unlock (&v.m);
+  // Every message came through the receive armed when it connected.
+  EXPECT_EQ (this->saurion.stats ().recv_arms, (uint64_t)clients);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+class SaurionScarceBufRingTest : public SaurionMultishotTest
+{
+protected:
+  SaurionScarceBufRingTest () { buf_ring = 2; }
+};
+
+TEST_F (SaurionScarceBufRingTest, rearmsTheReceiveOnceItEnds)
+{
+  if (!this->saurion.provided ())
+    {
+      GTEST_SKIP () << "kernel without provided buffer rings";
+    }
+  v.retain = true;
+  this->client.connect (1);
+  this->saurion.wait_connected (1);
+  this->client.send (1, "Hola", 0);
+  this->saurion.wait_readed (4);
+  this->client.send (1, "Hola", 0);
+  this->saurion.wait_readed (8);
+  pthread_mutex_lock (&v.m);
+  v.retain = false;
+  pthread_mutex_unlock (&v.m);
+  const uint64_t arms = this->saurion.stats ().recv_arms;
+  // Both buffers are retained, so the kernel ends the receive with
+  // -ENOBUFS and the message waits until one is released.
+  this->client.send (1, "Chau", 0);
+  settle ();
+  // The receive is not armed again while there is no buffer for it.
+  const struct saurion_stats starved = this->saurion.stats ();
+  EXPECT_EQ (starved.recv_arms, arms);
+  EXPECT_EQ (starved.buf_starved, 1UL);
+  pthread_mutex_lock (&v.m);
+  EXPECT_EQ (v.msgs.size (), 2UL);
+  for (const kept &k : v.leases)
+    {
+      this->saurion.release (k.lease);
+    }
+  v.leases.clear ();
+  pthread_mutex_unlock (&v.m);
+  this->saurion.wait_readed (12);
+  pthread_mutex_lock (&v.m);
+  ASSERT_EQ (v.msgs.size (), 3UL);
+  EXPECT_EQ (v.msgs[2], "Chau");
+  pthread_mutex_unlock (&v.m);
+  EXPECT_GT (this->saurion.stats ().recv_arms, 1UL);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (1);
+}
+
+class SaurionScarceReadTest : public SaurionViewTest
+{
+protected:
+  SaurionScarceReadTest () { buf_ring = 2; }
+};
+
+TEST_F (SaurionScarceReadTest, readsAgainOnceABufferIsReleased)
+{
+  if (!this->saurion.provided ())
+    {
+      GTEST_SKIP () << "kernel without provided buffer rings";
+    }
+  v.retain = true;
+  this->client.connect (1);
+  this->saurion.wait_connected (1);
+  this->client.send (1, "Hola", 0);
+  this->saurion.wait_readed (4);
+  this->client.send (1, "Hola", 0);
+  this->saurion.wait_readed (8);
+  pthread_mutex_lock (&v.m);
+  v.retain = false;
+  pthread_mutex_unlock (&v.m);
+  // The read posted after the second message finds no buffer left and
+  // waits for one instead of being posted again and again.
+  this->client.send (1, "Chau", 0);
+  settle ();
+  EXPECT_EQ (this->saurion.stats ().buf_starved, 1UL);
+  pthread_mutex_lock (&v.m);
+  EXPECT_EQ (v.msgs.size (), 2UL);
+  this->saurion.release (v.leases.front ().lease);
+  v.leases.erase (v.leases.begin ());
+  pthread_mutex_unlock (&v.m);
+  this->saurion.wait_readed (12);
+  pthread_mutex_lock (&v.m);
+  ASSERT_EQ (v.msgs.size (), 3UL);
+  EXPECT_EQ (v.msgs[2], "Chau");
+  for (const kept &k : v.leases)
+    {
+      this->saurion.release (k.lease);
+    }
+  v.leases.clear ();
+  pthread_mutex_unlock (&v.m);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (1);
+}
+
+using SaurionPauseTest = SaurionTest<LowSaurion>;
+
+TEST_F (SaurionPauseTest, pausedConnectionsAreNotRead)
+{
+  this->client.connect (1);
+  this->saurion.wait_connected (1);
+  const int fd = this->saurion.summary.fds.front ();
+  this->saurion.pause_read (fd);
+  settle ();
+  this->client.send (1, "Hola", 0);
+  settle ();
+  this->client.send (1, "Hola", 0);
+  settle ();
+  // A read already posted may still deliver the first message.
+  pthread_mutex_lock (&this->saurion.summary.readed_m);
+  EXPECT_LE (this->saurion.summary.readed, 4UL);
+  pthread_mutex_unlock (&this->saurion.summary.readed_m);
+  this->saurion.resume_read (fd);
+  this->saurion.wait_readed (8);
+  EXPECT_EQ (this->saurion.summary.readed, 8UL);
+  EXPECT_GT (this->saurion.stats ().read_pauses, 0UL);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (1);
+}
+
+class SaurionReadBudgetTest : public SaurionViewTest
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.read_max_msgs = 2;
+    v.saurion = &saurion;
+    v.retain = true;
+    saurion.readv = on_readv;
+    saurion.readv_arg = &v;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionReadBudgetTest, stopsReadingWhileTooManyMessagesAreHeld)
+{
+  this->client.connect (1);
+  this->saurion.wait_connected (1);
+  this->client.send (1, "Hola", 0);
+  this->saurion.wait_readed (4);
+  this->client.send (1, "Hola", 0);
+  this->saurion.wait_readed (8);
+  this->client.send (1, "Chau", 0);
+  settle ();
+  pthread_mutex_lock (&v.m);
+  EXPECT_EQ (v.msgs.size (), 2UL);
+  struct saurion_lease *const first = v.leases.front ().lease;
+  v.leases.erase (v.leases.begin ());
+  pthread_mutex_unlock (&v.m);
+  this->saurion.release (first);
+  this->saurion.wait_readed (12);
+  pthread_mutex_lock (&v.m);
+  EXPECT_EQ (v.msgs.back (), "Chau");
+  for (const kept &k : v.leases)
+    {
+      this->saurion.release (k.lease);
+    }
+  v.leases.clear ();
+  pthread_mutex_unlock (&v.m);
+  EXPECT_GT (this->saurion.stats ().read_pauses, 0UL);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (1);
+}
+
+class SaurionGlobalBudgetTest : public SaurionViewTest
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.read_global_msgs = 2;
+    v.saurion = &saurion;
+    v.retain = true;
+    saurion.readv = on_readv;
+    saurion.readv_arg = &v;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionGlobalBudgetTest, resumesEveryParkedConnection)
+{
+  uint32_t clients = 4;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  // Reads already posted still deliver. Only a connection done before the
+  // budget filled reads again, the others park.
+  this->client.send (1, "Hola", 0);
+  this->saurion.wait_readed (clients * 4);
+  this->client.send (1, "Chau", 0);
+  settle ();
+  pthread_mutex_lock (&v.m);
+  EXPECT_LE (v.msgs.size (), (size_t)clients + 1);
+  std::vector<kept> held = v.leases;
+  v.leases.clear ();
+  v.retain = false;
+  pthread_mutex_unlock (&v.m);
+  for (const kept &k : held)
+    {
+      this->saurion.release (k.lease);
+    }
+  this->saurion.wait_readed (clients * 8);
+  pthread_mutex_lock (&v.m);
+  EXPECT_EQ (v.msgs.size (), (size_t)clients * 2);
+  pthread_mutex_unlock (&v.m);
+  EXPECT_GE (this->saurion.stats ().read_pauses, (uint64_t)clients - 1);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+class SaurionSendBufTest : public SaurionTest<LowSaurion>
+{
+public:
+  struct completions
+  {
+    pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t c = PTHREAD_COND_INITIALIZER;
+    std::vector<void *> tokens;
+    int errors = 0;
+    std::vector<int> drained;
+  };
+
+  // on_sent
+  static void
+  on_sent (const int, void *const token, const int err, void *arg)
+  {
+    auto *done = static_cast<completions *> (arg);
+    pthread_mutex_lock (&done->m);
+    done->tokens.push_back (token);
+    done->errors += (err != 0);
+    pthread_cond_signal (&done->c);
+    pthread_mutex_unlock (&done->m);
+  }
+
+  // on_drain
+  static void
+  on_drain (const int fd, void *arg)
+  {
+    auto *done = static_cast<completions *> (arg);
+    pthread_mutex_lock (&done->m);
+    done->drained.push_back (fd);
+    pthread_cond_signal (&done->c);
+    pthread_mutex_unlock (&done->m);
+  }
+
+  // wait_drained
+  void
+  wait_drained (const size_t n)
+  {
+    pthread_mutex_lock (&done.m);
+    while (done.drained.size () < n)
+      {
+        pthread_cond_wait (&done.c, &done.m);
+      }
+    pthread_mutex_unlock (&done.m);
+  }
+
+  // wait_sent
+  void
+  wait_sent (const size_t n)
+  {
+    pthread_mutex_lock (&done.m);
+    while (done.tokens.size () < n)
+      {
+        pthread_cond_wait (&done.c, &done.m);
+      }
+    pthread_mutex_unlock (&done.m);
+  }
+
+  // connect_raw
+  int
+  connect_raw ()
+  {
+    const int sock = socket (AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset (&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons (this->client.getPort ());
+    inet_pton (AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect (sock, (struct sockaddr *)&addr, sizeof (addr)) < 0)
+      {
+        close (sock);
+        return -1;
+      }
+    return sock;
+  }
+
+  // read_all
+  static bool
+  read_all (const int sock, void *const buf, const size_t len)
+  {
+    size_t off = 0;
+    while (off < len)
+      {
+        ssize_t r = read (sock, (char *)buf + off, len - off);
+        if (r <= 0)
+          {
+            return false;
+          }
+        off += (size_t)r;
+      }
+    return true;
+  }
+
+  // read_frame
+  static std::string
+  read_frame (const int sock)
+  {
+    uint64_t be = 0;
+    if (!read_all (sock, &be, sizeof (be)))
+      {
+        return "";
+      }
+    std::string msg (be64toh (be) + 1, '\0');
+    if (!read_all (sock, msg.data (), msg.size ()) || msg.back () != 0)
+      {
+        return "";
+      }
+    msg.pop_back ();
+    return msg;
+  }
+
+  // write_frame
+  static bool
+  write_frame (const int sock, const std::string &msg)
+  {
+    const uint64_t be = htobe64 (msg.size ());
+    std::string frame ((const char *)&be, sizeof (be));
+    frame.append (msg);
+    frame.push_back ('\0');
+    size_t off = 0;
+    while (off < frame.size ())
+      {
+        ssize_t w = write (sock, frame.data () + off, frame.size () - off);
+        if (w <= 0)
+          {
+            return false;
+          }
+        off += (size_t)w;
+      }
+    return true;
+  }
+
+protected:
+  completions done;
+
+  void
+  SetUp () override
+  {
+    saurion.sent = on_sent;
+    saurion.sent_arg = &done;
+    saurion.SetUp (client.getPort ());
+  }
+};
+
+TEST_F (SaurionSendBufTest, sendsCallerBuffersAndReportsTheirTokens)
+{
+  const uint32_t msgs = 10;
+  // Binary payload sent up to an explicit length: the zero is part of it
+  // and the tail is not.
+  static const char payload[] = "Ho\0la mundo";
+  const std::string expected (payload, 5);
+  int tokens[msgs];
+  const int sock = connect_raw ();
+  ASSERT_GE (sock, 0);
+  this->saurion.wait_connected (1);
+  const int fd = this->saurion.summary.fds.front ();
+  for (uint32_t i = 0; i < msgs; ++i)
+    {
+      this->saurion.send_buf (fd, payload, expected.size (), &tokens[i]);
+    }
+  for (uint32_t i = 0; i < msgs; ++i)
+    {
+      EXPECT_EQ (read_frame (sock), expected);
+    }
+  wait_sent (msgs);
+  pthread_mutex_lock (&done.m);
+  EXPECT_EQ (done.errors, 0);
+  for (uint32_t i = 0; i < msgs; ++i)
+    {
+      EXPECT_EQ (std::count (done.tokens.begin (), done.tokens.end (),
+                             &tokens[i]),
+                 1);
+    }
+  pthread_mutex_unlock (&done.m);
+  EXPECT_EQ (this->saurion.summary.wrote, 0U);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+}
+
+TEST_F (SaurionSendBufTest, resumesShortWritesUntilTheFrameIsOut)
+{
+  // More chunks than a single writev accepts (UIO_MAXIOV), over a tiny send
+  // buffer.
+  std::string big ((1024 + 8) * CHUNK_SZ, 'A');
+  big.back () = '1';
+  const int sock = connect_raw ();
+  ASSERT_GE (sock, 0);
+  this->saurion.wait_connected (1);
+  const int fd = this->saurion.summary.fds.front ();
+  const int sndbuf = 4096;
+  setsockopt (fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof (sndbuf));
+  this->saurion.send (fd, 1, big.c_str ());
+  EXPECT_EQ (read_frame (sock), big);
+  this->saurion.wait_wrote (1);
+  EXPECT_EQ (this->saurion.summary.wrote, 1U);
+  EXPECT_GT (this->saurion.stats ().short_writes, 0UL);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+}
+
+TEST_F (SaurionSendBufTest, coalescesQueuedMessagesInOrder)
+{
+  const uint32_t msgs = 1000;
+  const int sock = connect_raw ();
+  ASSERT_GE (sock, 0);
+  this->saurion.wait_connected (1);
+  const int fd = this->saurion.summary.fds.front ();
+  for (uint32_t i = 0; i < msgs; ++i)
+    {
+      this->saurion.send (fd, 1, std::to_string (i).c_str ());
+    }
+  for (uint32_t i = 0; i < msgs; ++i)
+    {
+      ASSERT_EQ (read_frame (sock), std::to_string (i));
+    }
+  this->saurion.wait_wrote (msgs);
+  EXPECT_EQ (this->saurion.summary.wrote, msgs);
+  // The messages queued behind the first write left together.
+  EXPECT_GT (this->saurion.stats ().coalesced, 0UL);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+}
+
+TEST_F (SaurionSendBufTest, refusesMessagesToClosingConnections)
+{
+  const uint32_t msgs = 64;
+  const std::string big (16384, 'A');
+  static const char late[] = "late";
+  const int sock = connect_raw ();
+  ASSERT_GE (sock, 0);
+  // Socket buffers far smaller than the messages, so most of them wait in
+  // the queue.
+  const int rcvbuf = 65536;
+  setsockopt (sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof (rcvbuf));
+  this->saurion.wait_connected (1);
+  const int fd = this->saurion.summary.fds.front ();
+  const int sndbuf = 4096;
+  setsockopt (fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof (sndbuf));
+  this->saurion.send (fd, msgs, big.c_str ());
+  // Closed by the peer once they reached the queue, while most of them are
+  // still there.
+  settle ();
+  shutdown (sock, SHUT_WR);
+  this->saurion.wait_disconnected (1);
+  EXPECT_EQ (this->saurion.try_send (fd, late), EPIPE);
+  this->saurion.send_buf (fd, late, sizeof (late) - 1, (void *)late);
+  this->saurion.send (fd, 1, late);
+  wait_sent (1);
+  pthread_mutex_lock (&done.m);
+  EXPECT_EQ (done.errors, 1);
+  pthread_mutex_unlock (&done.m);
+  for (uint32_t i = 0; i < msgs; ++i)
+    {
+      ASSERT_EQ (read_frame (sock), big);
+    }
+  char c;
+  EXPECT_EQ (read (sock, &c, 1), 0);
+  close (sock);
+}
+
+class SaurionCoalesceLimitTest : public SaurionSendBufTest
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.send_coalesce_max = 1;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionCoalesceLimitTest, writesQueuedMessagesOneByOne)
+{
+  const uint32_t msgs = 1000;
+  const int sock = connect_raw ();
+  ASSERT_GE (sock, 0);
+  this->saurion.wait_connected (1);
+  const int fd = this->saurion.summary.fds.front ();
+  for (uint32_t i = 0; i < msgs; ++i)
+    {
+      this->saurion.send (fd, 1, std::to_string (i).c_str ());
+    }
+  for (uint32_t i = 0; i < msgs; ++i)
+    {
+      ASSERT_EQ (read_frame (sock), std::to_string (i));
+    }
+  this->saurion.wait_wrote (msgs);
+  EXPECT_EQ (this->saurion.stats ().coalesced, 0UL);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+}
+
+class SaurionBackpressureTest : public SaurionSendBufTest
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.send_high_water = 4096;
+    cfg.send_low_water = 1024;
+    cfg.slow_consumer = SAURION_SLOW_DISCONNECT;
+    saurion.drained = on_drain;
+    saurion.drained_arg = &done;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+
+  // connect_slow
+  int
+  connect_slow ()
+  {
+    const int sock = connect_raw ();
+    if (sock < 0)
+      {
+        return sock;
+      }
+    // Small socket buffers on both ends, so whatever the peer does not read
+    // piles up in the queue soon.
+    const int sz = 4096;
+    setsockopt (sock, SOL_SOCKET, SO_RCVBUF, &sz, sizeof (sz));
+    this->saurion.wait_connected (1);
+    const int fd = this->saurion.summary.fds.front ();
+    setsockopt (fd, SOL_SOCKET, SO_SNDBUF, &sz, sizeof (sz));
+    return sock;
+  }
+};
+
+TEST (SaurionConfig, rejectsInvalidWaterMarks)
+{
+  struct saurion_config cfg;
+  saurion_config_default (&cfg);
+  cfg.send_high_water = 1024;
+  cfg.send_low_water = 1024;
+  EXPECT_EQ (saurion_create_ex (&cfg), nullptr);
+  saurion_config_default (&cfg);
+  cfg.send_global_high = 1024;
+  cfg.send_global_low = 2048;
+  EXPECT_EQ (saurion_create_ex (&cfg), nullptr);
+  saurion_config_default (&cfg);
+  cfg.slow_consumer = SAURION_SLOW_DISCONNECT + 1;
+  EXPECT_EQ (saurion_create_ex (&cfg), nullptr);
+}
+
+TEST_F (SaurionBackpressureTest, refusesMessagesAboveTheHighWaterMark)
+{
+  const std::string msg (1024, 'B');
+  const int sock = connect_slow ();
+  ASSERT_GE (sock, 0);
+  const int fd = this->saurion.summary.fds.front ();
+  uint32_t accepted = 0;
+  int ret = 0;
+  while (accepted < 100000
+         && (ret = this->saurion.try_send (fd, msg.c_str ())) == 0)
+    {
+      ++accepted;
+    }
+  EXPECT_EQ (ret, EAGAIN);
+  for (uint32_t i = 0; i < accepted; ++i)
+    {
+      ASSERT_EQ (read_frame (sock), msg);
+    }
+  wait_drained (1);
+  pthread_mutex_lock (&done.m);
+  EXPECT_EQ (done.drained.front (), fd);
+  pthread_mutex_unlock (&done.m);
+  EXPECT_GT (this->saurion.stats ().over_limit, 0UL);
+  EXPECT_EQ (this->saurion.try_send (fd, msg.c_str ()), 0);
+  EXPECT_EQ (read_frame (sock), msg);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+}
+
+TEST_F (SaurionBackpressureTest, disconnectsSlowConsumers)
+{
+  const std::string msg (1024, 'C');
+  const int sock = connect_slow ();
+  ASSERT_GE (sock, 0);
+  const int fd = this->saurion.summary.fds.front ();
+  // The peer reads nothing, so its queue only grows.
+  this->saurion.send (fd, 10000, msg.c_str ());
+  this->saurion.wait_disconnected (1);
+  EXPECT_GT (this->saurion.stats ().over_limit, 0UL);
+  close (sock);
+}
+
+class SaurionBlockingSendTest : public SaurionBackpressureTest
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.send_high_water = 4096;
+    cfg.send_low_water = 1024;
+    cfg.slow_consumer = SAURION_SLOW_BLOCK;
+    saurion.drained = on_drain;
+    saurion.drained_arg = &done;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionBlockingSendTest, blocksSendersUntilTheQueueDrains)
+{
+  const std::string msg (1024, 'D');
+  const uint32_t msgs = 256;
+  const int sock = connect_slow ();
+  ASSERT_GE (sock, 0);
+  const int fd = this->saurion.summary.fds.front ();
+  std::atomic<uint32_t> sent (0);
+  std::thread sender ([&] {
+    for (uint32_t i = 0; i < msgs; ++i)
+      {
+        this->saurion.send (fd, 1, msg.c_str ());
+        ++sent;
+      }
+  });
+  settle ();
+  // The peer reads nothing yet, so the sender waits above the high-water
+  // mark.
+  EXPECT_LT (sent.load (), msgs);
+  uint32_t received = 0;
+  while (received < msgs && read_frame (sock) == msg)
+    {
+      ++received;
+    }
+  sender.join ();
+  EXPECT_EQ (received, msgs);
+  EXPECT_EQ (sent.load (), msgs);
+  wait_drained (1);
+  EXPECT_GT (this->saurion.stats ().over_limit, 0UL);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+}
+
+class SaurionStreamTest : public SaurionSendBufTest
+{
+public:
+  struct streamed
+  {
+    pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t c = PTHREAD_COND_INITIALIZER;
+    std::vector<int64_t> lens;
+    std::string piece;
+    std::vector<std::string> msgs;
+    std::vector<int> errs;
+    int64_t largest = 0;
+  };
+
+  // on_read_begin
+  static void
+  on_read_begin (const int, const int64_t len, void *arg)
+  {
+    auto *st = static_cast<streamed *> (arg);
+    pthread_mutex_lock (&st->m);
+    st->lens.push_back (len);
+    st->piece.clear ();
+    pthread_mutex_unlock (&st->m);
+  }
+
+  // on_read_chunk
+  static void
+  on_read_chunk (const int, const void *const content, const int64_t len,
+                 void *arg)
+  {
+    auto *st = static_cast<streamed *> (arg);
+    pthread_mutex_lock (&st->m);
+    st->piece.append ((const char *)content, (size_t)len);
+    st->largest = std::max (st->largest, len);
+    pthread_mutex_unlock (&st->m);
+  }
+
+  // on_read_end
+  static void
+  on_read_end (const int, const int err, void *arg)
+  {
+    auto *st = static_cast<streamed *> (arg);
+    pthread_mutex_lock (&st->m);
+    st->msgs.push_back (st->piece);
+    st->errs.push_back (err);
+    pthread_cond_signal (&st->c);
+    pthread_mutex_unlock (&st->m);
+  }
+
+  // wait_streamed
+  void
+  wait_streamed (const size_t n)
+  {
+    pthread_mutex_lock (&st.m);
+    while (st.msgs.size () < n)
+      {
+        pthread_cond_wait (&st.c, &st.m);
+      }
+    pthread_mutex_unlock (&st.m);
+  }
+
+protected:
+  streamed st;
+
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.max_msg_size = CHUNK_SZ * 8;
+    saurion.read_begin = on_read_begin;
+    saurion.read_chunk = on_read_chunk;
+    saurion.read_end = on_read_end;
+    saurion.stream_arg = &st;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionStreamTest, streamsMessagesLongerThanARead)
+{
+  std::string big (CHUNK_SZ * 3 + 7, '\0');
+  for (size_t i = 0; i < big.size (); ++i)
+    {
+      big[i] = (char)('a' + i % 26);
+    }
+  const int sock = connect_raw ();
+  ASSERT_GE (sock, 0);
+  this->saurion.wait_connected (1);
+  ASSERT_TRUE (write_frame (sock, big));
+  ASSERT_TRUE (write_frame (sock, "Hola"));
+  ASSERT_TRUE (write_frame (sock, big));
+  wait_streamed (2);
+  this->saurion.wait_readed (4);
+  pthread_mutex_lock (&st.m);
+  EXPECT_EQ (st.lens, std::vector<int64_t> (2, (int64_t)big.size ()));
+  EXPECT_EQ (st.errs, std::vector<int> (2, 0));
+  EXPECT_EQ (st.msgs[0], big);
+  EXPECT_EQ (st.msgs[1], big);
+  // Nothing is gathered: every piece is at most one read.
+  EXPECT_LE (st.largest, (int64_t)CHUNK_SZ);
+  pthread_mutex_unlock (&st.m);
+  EXPECT_EQ (this->saurion.summary.readed, 4UL);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+}
+
+TEST_F (SaurionStreamTest, closesConnectionsAnnouncingOversizedMessages)
+{
+  const int sock = connect_raw ();
+  ASSERT_GE (sock, 0);
+  this->saurion.wait_connected (1);
+  const uint64_t be = htobe64 (1ULL << 40);
+  ASSERT_EQ (write (sock, &be, sizeof (be)), (ssize_t)sizeof (be));
+  char c = 0;
+  EXPECT_EQ (read (sock, &c, 1), 0);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+  EXPECT_EQ (this->saurion.stats ().oversized, 1UL);
+  pthread_mutex_lock (&st.m);
+  EXPECT_TRUE (st.lens.empty ());
+  pthread_mutex_unlock (&st.m);
+}
+
+class SaurionZeroCopyTest : public SaurionSendBufTest
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.zc_threshold = 1024;
+    saurion.sent = on_sent;
+    saurion.sent_arg = &done;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionZeroCopyTest, releasesBuffersOnlyAfterTheNotification)
+{
+  const std::string big (CHUNK_SZ * 3, 'Z');
+  std::vector<char> blob (CHUNK_SZ * 2);
+  for (size_t i = 0; i < blob.size (); ++i)
+    {
+      blob[i] = (char)i;
+    }
+  int token = 0;
+  const int sock = connect_raw ();
+  ASSERT_GE (sock, 0);
+  this->saurion.wait_connected (1);
+  const int fd = this->saurion.summary.fds.front ();
+  this->saurion.send (fd, 1, "Hola");
+  this->saurion.send (fd, 1, big.c_str ());
+  this->saurion.send_buf (fd, blob.data (), blob.size (), &token);
+  EXPECT_EQ (read_frame (sock), "Hola");
+  EXPECT_EQ (read_frame (sock), big);
+  EXPECT_EQ (read_frame (sock), std::string (blob.data (), blob.size ()));
+  wait_sent (1);
+  this->saurion.wait_wrote (2);
+  pthread_mutex_lock (&done.m);
+  EXPECT_EQ (done.errors, 0);
+  EXPECT_EQ (done.tokens.front (), &token);
+  pthread_mutex_unlock (&done.m);
+  struct saurion_stats st = this->saurion.stats ();
+  // Only the two large messages qualify, when the kernel supports it, and
+  // they share a write when they were queued together.
+  EXPECT_LE (st.zc_sends, this->saurion.zero_copy () ? 2UL : 0UL);
+  EXPECT_GE (st.zc_sends, this->saurion.zero_copy () ? 1UL : 0UL);
+  EXPECT_LE (st.zc_copied, st.zc_sends);
+  close (sock);
+  this->saurion.wait_disconnected (1);
+}
+
+class SaurionSqpollTest : public SaurionTest<LowSaurion>
+{
+public:
+  static constexpr uint32_t IDLE_MS = 5;
+
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.setup_flags |= IORING_SETUP_SQPOLL;
+    cfg.sq_thread_idle = IDLE_MS;
+    cfg.sq_thread_cpu = (sysconf (_SC_NPROCESSORS_ONLN) >= 2 ? 0 : -1);
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionSqpollTest, wakesIdleSubmissionThreads)
+{
+  uint32_t clients = 5;
+  uint32_t msgs = 20;
+  struct timespec idle;
+  idle.tv_sec = 0;
+  idle.tv_nsec = IDLE_MS * 4 * 1000000L;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  EXPECT_EQ (this->saurion.summary.connected, clients);
+  for (uint32_t i = 1; i <= 3; ++i)
+    {
+      this->client.send (msgs, "Hola", 0);
+      this->saurion.wait_readed (i * msgs * clients * 4);
+      this->saurion.sendAll (msgs, "Hola");
+      this->saurion.wait_wrote (i * msgs * clients);
+      nanosleep (&idle, nullptr);
+    }
+  EXPECT_EQ (this->saurion.summary.readed, 3 * msgs * clients * 4);
+  EXPECT_EQ (this->saurion.summary.wrote, 3 * msgs * clients);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+  EXPECT_EQ (this->saurion.summary.disconnected, clients);
+}
+
+class SaurionOwnerTest : public SaurionTest<LowSaurion>
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 4;
+    cfg.single_issuer = 1;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionOwnerTest, ringsAreSingleIssuer)
+{
+  for (uint32_t flags : this->saurion.ring_flags ())
+    {
+      EXPECT_TRUE (flags & IORING_SETUP_SINGLE_ISSUER);
+      EXPECT_EQ ((bool)(flags & IORING_SETUP_DEFER_TASKRUN),
+                 !(flags & IORING_SETUP_SQPOLL));
+    }
+}
+
+TEST_F (SaurionOwnerTest, postsForeignWorkToTheOwners)
+{
+  uint32_t clients = 20;
+  uint32_t msgs = 100;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  EXPECT_EQ (this->saurion.summary.connected, clients);
+  this->saurion.sendAll (msgs, "Hola");
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_readed (msgs * clients * 4);
+  this->saurion.wait_wrote (msgs * clients);
+  EXPECT_EQ (this->saurion.summary.readed, msgs * clients * 4);
+  EXPECT_EQ (this->saurion.summary.wrote, msgs * clients);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+  EXPECT_EQ (this->saurion.summary.disconnected, clients);
+}
+
+class SaurionAffinityTest : public SaurionTest<LowSaurion>
+{
+public:
+  static constexpr uint32_t N_RINGS = 4;
+
+  // pinned_to
+  static uint32_t
+  pinned_to (const int, const uint32_t *, const uint32_t, void *arg)
+  {
+    return *static_cast<uint32_t *> (arg);
+  }
+
+protected:
+  uint32_t target = 1;
+
+  // SetUp
+  void
+  SetUp () override
+  {
+    // Every test starts the server with its own policy.
+  }
+
+  // start
+  void
+  start (const uint32_t affinity, saurion_pick_ring pick = nullptr,
+         const uint32_t reuseport = 0)
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = N_RINGS;
+    cfg.affinity = affinity;
+    cfg.pick_ring = pick;
+    cfg.pick_ring_arg = &target;
+    cfg.reuseport = reuseport;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+
+  // echo
+  void
+  echo (const uint32_t clients, const uint32_t msgs)
+  {
+    this->client.connect (clients);
+    this->saurion.wait_connected (clients);
+    this->saurion.sendAll (msgs, "Hola");
+    this->client.send (msgs, "Hola", 0);
+    this->saurion.wait_readed (msgs * clients * 4);
+    this->saurion.wait_wrote (msgs * clients);
+    EXPECT_EQ (this->saurion.summary.readed, msgs * clients * 4);
+    EXPECT_EQ (this->saurion.summary.wrote, msgs * clients);
+  }
+};
+
+TEST_F (SaurionAffinityTest, customPolicyPinsEveryConnection)
+{
+  start (SAURION_AFFINITY_ROUND_ROBIN, pinned_to);
+  uint32_t clients = 8;
+  echo (clients, 20);
+  std::vector<uint32_t> conns = this->saurion.ring_conns ();
+  for (uint32_t i = 0; i < conns.size (); ++i)
+    {
+      EXPECT_EQ (conns[i], (i == target % conns.size () ? clients : 0U));
+    }
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+  for (uint32_t c : this->saurion.ring_conns ())
+    {
+      EXPECT_EQ (c, 0U);
+    }
+}
+
+TEST_F (SaurionAffinityTest, leastLoadedBalancesConnections)
+{
+  start (SAURION_AFFINITY_LEAST_LOADED);
+  std::vector<uint32_t> conns = this->saurion.ring_conns ();
+  uint32_t clients = 2 * (uint32_t)conns.size ();
+  echo (clients, 10);
+  for (uint32_t c : this->saurion.ring_conns ())
+    {
+      EXPECT_EQ (c, 2U);
+    }
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
+
+TEST_F (SaurionAffinityTest, reuseportAcceptsOnEveryRing)
+{
+  start (SAURION_AFFINITY_ROUND_ROBIN, pinned_to, 1);
+  uint32_t clients = 32;
+  echo (clients, 5);
+  uint32_t total = 0;
+  uint32_t used = 0;
+  for (uint32_t c : this->saurion.ring_conns ())
+    {
+      total += c;
+      used += (c > 0);
+    }
+  EXPECT_EQ (total, clients);
+  EXPECT_GT (used, 1U);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+  for (uint32_t c : this->saurion.ring_conns ())
+    {
+      EXPECT_EQ (c, 0U);
+    }
+}
+
+class SaurionAcceptErrorTest : public SaurionTest<LowSaurion>
+{
+protected:
+  struct rlimit lim;
+
+  void
+  SetUp () override
+  {
+    // Accepts take the descriptor limit in force when they are armed, so it
+    // is lowered before the listeners start, leaving room for a few more.
+    ASSERT_EQ (getrlimit (RLIMIT_NOFILE, &lim), 0);
+    const int probe = dup (0);
+    ASSERT_GE (probe, 0);
+    close (probe);
+    struct rlimit low = lim;
+    low.rlim_cur = (rlim_t)probe + 64;
+    ASSERT_EQ (setrlimit (RLIMIT_NOFILE, &low), 0);
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 2;
+    cfg.reuseport = 1;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+
+  void
+  TearDown () override
+  {
+    SaurionTest<LowSaurion>::TearDown ();
+    setrlimit (RLIMIT_NOFILE, &lim);
+  }
+};
+
+TEST_F (SaurionAcceptErrorTest, keepsAcceptingAfterRunningOutOfDescriptors)
+{
+  this->client.connect (1);
+  this->saurion.wait_connected (1);
+  std::vector<int> taken;
+  for (int fd = dup (0); fd >= 0; fd = dup (0))
+    {
+      taken.push_back (fd);
+    }
+  // Every accept now fails with EMFILE, which is reported and retried.
+  this->client.connect (1);
+  settle ();
+  pthread_mutex_lock (&this->saurion.summary.errors_m);
+  EXPECT_GT (this->saurion.summary.errors, 0U);
+  pthread_mutex_unlock (&this->saurion.summary.errors_m);
+  pthread_mutex_lock (&this->saurion.summary.connected_m);
+  EXPECT_EQ (this->saurion.summary.connected, 1U);
+  pthread_mutex_unlock (&this->saurion.summary.connected_m);
+  for (const int fd : taken)
+    {
+      close (fd);
+    }
+  this->saurion.wait_connected (2);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (2);
+}
+
+class SaurionHighReuseportTest : public SaurionTest<HighSaurion>
+{
+protected:
+  void
+  SetUp () override
+  {
+    struct saurion_config cfg;
+    saurion_config_default (&cfg);
+    cfg.n_threads = 4;
+    cfg.reuseport = 1;
+    saurion.SetUp (client.getPort (), &cfg);
+  }
+};
+
+TEST_F (SaurionHighReuseportTest, setSocketsOpensOneListenerPerRing)
+{
+  // Another SO_REUSEPORT socket only binds to the port if every socket
+  // listening on it has the option as well.
+  int sock = socket (PF_INET, SOCK_STREAM, 0);
+  ASSERT_GE (sock, 0);
+  int enable = 1;
+  EXPECT_EQ (setsockopt (sock, SOL_SOCKET, SO_REUSEADDR, &enable,
+                         sizeof (enable)),
+             0);
+  EXPECT_EQ (setsockopt (sock, SOL_SOCKET, SO_REUSEPORT, &enable,
+                         sizeof (enable)),
+             0);
+  struct sockaddr_in addr;
+  memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (this->client.getPort ());
+  addr.sin_addr.s_addr = htonl (INADDR_ANY);
+  EXPECT_EQ (bind (sock, (const struct sockaddr *)&addr, sizeof (addr)), 0);
+  close (sock);
+  uint32_t clients = 8;
+  uint32_t msgs = 5;
+  this->client.connect (clients);
+  this->saurion.wait_connected (clients);
+  this->saurion.sendAll (msgs, "Hola");
+  this->client.send (msgs, "Hola", 0);
+  this->saurion.wait_readed (msgs * clients * 4);
+  this->saurion.wait_wrote (msgs * clients);
+  EXPECT_EQ (this->saurion.summary.readed, msgs * clients * 4);
+  this->client.disconnect ();
+  this->saurion.wait_disconnected (clients);
+}
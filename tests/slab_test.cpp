@@ -0,0 +1,201 @@
+#include "config.h" // for SUCCESS_CODE, ERROR_CODE
+#include "slab.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread> // for jthread
+#include <vector> // for vector
+
+struct item
+{
+  uint64_t len;
+  uint64_t data[];
+};
+
+static std::atomic<int> inits (0);
+static std::atomic<int> finis (0);
+
+static int
+init_item (void *obj, uint64_t capacity, void *)
+{
+  static_cast<struct item *> (obj)->len = capacity;
+  inits++;
+  return SUCCESS_CODE;
+}
+
+static void
+fini_item (void *, void *)
+{
+  finis++;
+}
+
+class SlabTest : public ::testing::Test
+{
+public:
+  struct slab *slab = nullptr;
+
+protected:
+  void
+  SetUp () override
+  {
+    inits = 0;
+    finis = 0;
+    slab = slab_create (sizeof (struct item), sizeof (uint64_t), 4, 8,
+                        init_item, fini_item, nullptr);
+    ASSERT_NE (slab, nullptr);
+  }
+
+  void
+  TearDown () override
+  {
+    slab_destroy (slab);
+    slab = nullptr;
+  }
+
+  struct slab_stats
+  stats ()
+  {
+    struct slab_stats st;
+    slab_get_stats (slab, &st);
+    return st;
+  }
+};
+
+TEST_F (SlabTest, roundsUpToPowerOfTwo)
+{
+  for (uint64_t items : { 0UL, 1UL, 2UL, 3UL, 5UL, 8UL })
+    {
+      auto *obj = static_cast<struct item *> (slab_alloc (slab, items));
+      ASSERT_NE (obj, nullptr);
+      uint64_t expected = 1;
+      while (expected < items)
+        {
+          expected <<= 1;
+        }
+      EXPECT_EQ (slab_capacity (obj), expected);
+      EXPECT_EQ (obj->len, expected);
+      for (uint64_t i = 0; i < expected; ++i)
+        {
+          obj->data[i] = i;
+        }
+      slab_free (obj);
+    }
+}
+
+TEST_F (SlabTest, reusesReleasedObjects)
+{
+  void *first = slab_alloc (slab, 3);
+  ASSERT_NE (first, nullptr);
+  slab_free (first);
+  void *second = slab_alloc (slab, 4);
+  EXPECT_EQ (first, second);
+  slab_free (second);
+  EXPECT_EQ (inits, 1);
+  EXPECT_EQ (finis, 0);
+  EXPECT_EQ (stats ().allocs, 2UL);
+  EXPECT_EQ (stats ().misses, 1UL);
+  EXPECT_EQ (stats ().cached, 1UL);
+}
+
+TEST_F (SlabTest, keepsClassesApart)
+{
+  void *small = slab_alloc (slab, 1);
+  slab_free (small);
+  void *big = slab_alloc (slab, 2);
+  EXPECT_NE (small, big);
+  EXPECT_EQ (slab_capacity (big), 2UL);
+  slab_free (big);
+  EXPECT_EQ (stats ().misses, 2UL);
+}
+
+TEST_F (SlabTest, oversizeObjectsAreNotCached)
+{
+  void *obj = slab_alloc (slab, 100);
+  ASSERT_NE (obj, nullptr);
+  EXPECT_EQ (slab_capacity (obj), 100UL);
+  slab_free (obj);
+  EXPECT_EQ (finis, 1);
+  EXPECT_EQ (stats ().cached, 0UL);
+}
+
+TEST_F (SlabTest, limitsCachedObjectsPerClass)
+{
+  std::vector<void *> objs;
+  for (int i = 0; i < 10; ++i)
+    {
+      objs.push_back (slab_alloc (slab, 1));
+    }
+  for (void *obj : objs)
+    {
+      slab_free (obj);
+    }
+  EXPECT_EQ (stats ().cached, 8UL);
+  EXPECT_EQ (finis, 2);
+}
+
+TEST_F (SlabTest, destroyFinalizesCachedObjects)
+{
+  slab_free (slab_alloc (slab, 1));
+  slab_free (slab_alloc (slab, 4));
+  slab_destroy (slab);
+  slab = nullptr;
+  EXPECT_EQ (finis, 2);
+}
+
+TEST_F (SlabTest, failedInitDiscardsObject)
+{
+  struct slab *failing = slab_create (
+      sizeof (struct item), sizeof (uint64_t), 4, 8,
+      [] (void *, uint64_t, void *) { return ERROR_CODE; }, nullptr, nullptr);
+  ASSERT_NE (failing, nullptr);
+  EXPECT_EQ (slab_alloc (failing, 1), nullptr);
+  slab_destroy (failing);
+}
+
+TEST_F (SlabTest, steadyStateDoesNotAllocate)
+{
+  std::vector<void *> objs;
+  for (int round = 0; round < 100; ++round)
+    {
+      for (int i = 0; i < 8; ++i)
+        {
+          objs.push_back (slab_alloc (slab, (uint64_t)i % 5));
+        }
+      for (void *obj : objs)
+        {
+          slab_free (obj);
+        }
+      objs.clear ();
+    }
+  EXPECT_EQ (stats ().allocs, 800UL);
+  EXPECT_EQ (stats ().misses, 8UL);
+}
+
+constexpr int N_THREADS = 16;
+constexpr int ITEMS_PER_THREAD = 1000;
+
+TEST_F (SlabTest, ConcurrentAllocAndFree)
+{
+  std::vector<std::jthread> threads;
+  for (int i = 0; i < N_THREADS; ++i)
+    {
+      threads.emplace_back ([this, i] () {
+        for (int j = 0; j < ITEMS_PER_THREAD; ++j)
+          {
+            auto *obj
+                = static_cast<struct item *> (slab_alloc (slab, i % 4 + 1));
+            ASSERT_NE (obj, nullptr);
+            obj->data[0] = j;
+            slab_free (obj);
+          }
+      });
+    }
+
+  for (auto &thread : threads)
+    {
+      thread.join ();
+    }
+
+  EXPECT_EQ (stats ().allocs, (uint64_t)(N_THREADS * ITEMS_PER_THREAD));
+  EXPECT_EQ (stats ().cached + (uint64_t)finis, stats ().misses);
+}
@@ -1,6 +1,8 @@
+#include "chunk_pool.h"         // for chunk_pool_create, chunk_pool_get_...
 #include "config.h"             // for CHUNK_SZ, SUCCESS_CODE, ERROR_CODE
-#include "linked_list.h"        // for list_free
+#include "handle_table.h"       // for handle_table_create, handle_table_...
 #include "low_saurion_secret.h" // for request, set_request, read_chunk
+#include "slab.h"               // for slab_alloc, slab_get_stats
 #include "gtest/gtest.h"        // for Message, TestPartResult, Test (ptr o...
 
 #include <arpa/inet.h> // for htonl, ntohl
@@ -157,7 +159,8 @@ check_iovec (uint64_t size, uint8_t h)
   int res = 0;
   for (uint64_t i = 0; i < amount; ++i)
     {
-      res = allocate_iovec (&iovecs[i], amount, i, full_size, chd_ptr);
+      res = allocate_iovec (&iovecs[i], amount, i, full_size, CHUNK_SZ,
+                            chd_ptr);
       EXPECT_EQ (res, SUCCESS_CODE);
 
       uint64_t exp_iov_len
@@ -166,7 +169,7 @@ check_iovec (uint64_t size, uint8_t h)
       EXPECT_EQ (exp_iov_len, iovecs[i].iov_len);
 
       res = initialize_iovec (&iovecs[i], amount, i, msg.get (), content_size,
-                              h);
+                              CHUNK_SZ, h);
       EXPECT_EQ (res, SUCCESS_CODE);
 
       if (i == 0)
@@ -321,11 +324,13 @@ check_set_msgs (const std::vector<uint64_t> &s, const std::vector<int> &a,
   auto msgs_vector = generate_messages (s, a);
 
   struct request *req = nullptr;
-  struct Node *list = nullptr;
+  struct handle_table *table
+      = handle_table_create (SAURION_RING_SIZE, free_request);
+  struct slab *slab = request_slab_create (nullptr, CHUNK_SZ);
 
   auto total_size = std::accumulate (s.begin (), s.end (), 0) + s.size () * 9
                     + std::accumulate (a.begin (), a.end (), 0);
-  int res = set_request (&req, &list, total_size,
+  int res = set_request (&req, slab, table, total_size, CHUNK_SZ,
                          msgs_vector[s.size ()].get (), 0);
   EXPECT_EQ (res, SUCCESS_CODE);
   uint64_t iovs = std::ceil ((float)total_size / CHUNK_SZ);
@@ -373,7 +378,8 @@ check_set_msgs (const std::vector<uint64_t> &s, const std::vector<int> &a,
       free (req->prev);
     }
 
-  list_free (&list);
+  handle_table_destroy (table);
+  request_slab_destroy (slab);
 }
 
 TEST (unit_saurion, initialize_correct_with_header)
@@ -383,10 +389,11 @@ TEST (unit_saurion, initialize_correct_with_header)
   uint64_t msg_size = content_size + (sizeof (uint64_t) + 1);
   auto *iovec = new struct iovec;
   auto **chd_ptr = new void *;
-  int res = allocate_iovec (&iovec[0], 1, 0, msg_size, chd_ptr);
+  int res = allocate_iovec (&iovec[0], 1, 0, msg_size, CHUNK_SZ, chd_ptr);
   EXPECT_EQ (res, SUCCESS_CODE);
   EXPECT_EQ (iovec[0].iov_len, msg_size);
-  res = initialize_iovec (&iovec[0], 1, 0, message, content_size, 1);
+  res = initialize_iovec (&iovec[0], 1, 0, message, content_size, CHUNK_SZ,
+                          1);
   EXPECT_EQ (res, SUCCESS_CODE);
   uint64_t size = *(uint64_t *)iovec[0].iov_base;
   size = ntohll (size);
@@ -427,14 +434,14 @@ TEST (unit_saurion, creates_iovecs_correctly)
 TEST (unit_saurion, tries_alloc_null_iovec)
 {
   struct iovec *iovec_null = nullptr;
-  int res = allocate_iovec (iovec_null, 0, 0, 0, nullptr);
+  int res = allocate_iovec (iovec_null, 0, 0, 0, CHUNK_SZ, nullptr);
   EXPECT_EQ (res, ERROR_CODE);
 }
 
 TEST (unit_saurion, tries_init_null_iovec)
 {
   struct iovec *iovec_null = nullptr;
-  int res = initialize_iovec (iovec_null, 0, 0, nullptr, 0, 1);
+  int res = initialize_iovec (iovec_null, 0, 0, nullptr, 0, CHUNK_SZ, 1);
   EXPECT_EQ (res, ERROR_CODE);
 }
 
@@ -447,29 +454,109 @@ TEST (unit_saurion, create_iovec_for_null_msg)
 TEST (unit_saurion, set_request_first_creation_and_reset)
 {
   struct request *req = nullptr;
-  struct Node *list = nullptr;
+  struct handle_table *table
+      = handle_table_create (SAURION_RING_SIZE, free_request);
+  struct slab *slab = request_slab_create (nullptr, CHUNK_SZ);
   uint64_t size = 2.5 * CHUNK_SZ;
   auto msg = fill_with_alphabet (size, 0);
-  int res = set_request (&req, &list, size, msg.get (), 1);
+  int res = set_request (&req, slab, table, size, CHUNK_SZ, msg.get (), 1);
   check_request (res, req, 3UL);
   req->client_socket = 123;
   req->event_type = 456;
-  res = set_request (&req, &list, size, msg.get (), 1);
+  res = set_request (&req, slab, table, size, CHUNK_SZ, msg.get (), 1);
   check_request (res, req, 3UL);
   EXPECT_EQ (req->client_socket, 123);
   EXPECT_EQ (req->event_type, 456);
-  list_free (&list);
+  handle_table_destroy (table);
+  request_slab_destroy (slab);
 }
 
 TEST (unit_saurion, test_free_request)
 {
   struct request *req = nullptr;
-  struct Node *list = nullptr;
+  struct handle_table *table
+      = handle_table_create (SAURION_RING_SIZE, free_request);
+  struct slab *slab = request_slab_create (nullptr, CHUNK_SZ);
   uint64_t size = 2.5 * CHUNK_SZ;
   auto msg = fill_with_alphabet (size, 0);
-  int res = set_request (&req, &list, size, msg.get (), 1);
+  int res = set_request (&req, slab, table, size, CHUNK_SZ, msg.get (), 1);
   check_request (res, req, 3UL);
-  list_free (&list);
+  EXPECT_EQ (handle_table_size (table), 1U);
+  EXPECT_EQ (handle_table_get (table, req->handle), req);
+  EXPECT_EQ (handle_table_delete (table, req->handle), SUCCESS_CODE);
+  EXPECT_EQ (handle_table_size (table), 0U);
+  handle_table_destroy (table);
+  request_slab_destroy (slab);
+}
+
+TEST (unit_saurion, requests_take_buffers_from_chunk_pool)
+{
+  struct request *req = nullptr;
+  struct chunk_pool *pool = chunk_pool_create (CHUNK_SZ, 16, 0);
+  struct handle_table *table
+      = handle_table_create (SAURION_RING_SIZE, free_request);
+  struct slab *slab = request_slab_create (pool, CHUNK_SZ);
+  uint64_t size = 2.5 * CHUNK_SZ;
+  auto msg = fill_with_alphabet (size, 0);
+  int res = set_request (&req, slab, table, size, CHUNK_SZ, msg.get (), 1);
+  check_request (res, req, 3UL);
+  struct chunk_pool_stats stats;
+  chunk_pool_get_stats (pool, &stats);
+  EXPECT_EQ (stats.in_use, req->iovec_owned);
+  EXPECT_EQ (handle_table_delete (table, req->handle), SUCCESS_CODE);
+  chunk_pool_get_stats (pool, &stats);
+  EXPECT_EQ (stats.in_use, 4UL);
+  req = nullptr;
+  res = set_request (&req, slab, table, size, CHUNK_SZ, msg.get (), 1);
+  check_request (res, req, 3UL);
+  chunk_pool_get_stats (pool, &stats);
+  EXPECT_EQ (stats.high_water, 4UL);
+  handle_table_destroy (table);
+  request_slab_destroy (slab);
+  chunk_pool_get_stats (pool, &stats);
+  EXPECT_EQ (stats.in_use, 0UL);
+  chunk_pool_destroy (pool);
+}
+
+TEST (unit_saurion, single_chunk_requests_know_their_fixed_buffer)
+{
+  struct chunk_pool *pool = chunk_pool_create (CHUNK_SZ, 16, 0);
+  ASSERT_EQ (chunk_pool_reserve (pool, 1), SUCCESS_CODE);
+  struct handle_table *table
+      = handle_table_create (SAURION_RING_SIZE, free_request);
+  struct slab *slab = request_slab_create (pool, CHUNK_SZ);
+  struct request *req = nullptr;
+  int res = set_request (&req, slab, table, CHUNK_SZ, CHUNK_SZ, nullptr, 0);
+  check_request (res, req, 1UL);
+  EXPECT_EQ (req->buf_index, 0);
+  struct request *big = nullptr;
+  res = set_request (&big, slab, table, 2 * CHUNK_SZ, CHUNK_SZ, nullptr, 0);
+  check_request (res, big, 2UL);
+  EXPECT_EQ (big->buf_index, -1);
+  handle_table_destroy (table);
+  request_slab_destroy (slab);
+  chunk_pool_destroy (pool);
+}
+
+TEST (unit_saurion, requests_carry_the_configured_chunk_size)
+{
+  const uint64_t chunk_sz = 2 * CHUNK_SZ;
+  struct chunk_pool *pool = chunk_pool_create (chunk_sz, 16, 0);
+  struct slab *slabs[] = { request_slab_create (pool, chunk_sz),
+                           request_slab_create (nullptr, chunk_sz) };
+  for (struct slab *slab : slabs)
+    {
+      auto *req = (struct request *)slab_alloc (slab, 2);
+      ASSERT_NE (req, nullptr);
+      EXPECT_EQ (req->iovec_owned, 2UL);
+      EXPECT_EQ (req->iov[0].iov_len, chunk_sz);
+      EXPECT_EQ (req->iov[1].iov_len, chunk_sz);
+      // The whole buffer is usable, not just CHUNK_SZ bytes of it.
+      memset (req->iov[1].iov_base, 'x', chunk_sz);
+      slab_free (req);
+      request_slab_destroy (slab);
+    }
+  chunk_pool_destroy (pool);
 }
 
 TEST (unit_saurion, EmptyRequest)
@@ -492,8 +579,10 @@ TEST (unit_saurion, SingleMessageComplete)
   uint64_t msg_size = strlen (message);
 
   struct request *req = nullptr;
-  struct Node *list = nullptr;
-  int res = set_request (&req, &list, msg_size, message, 1);
+  struct handle_table *table
+      = handle_table_create (SAURION_RING_SIZE, free_request);
+  struct slab *slab = request_slab_create (nullptr, CHUNK_SZ);
+  int res = set_request (&req, slab, table, msg_size, CHUNK_SZ, message, 1);
   EXPECT_EQ (res, SUCCESS_CODE);
 
   void *dest = nullptr;
@@ -505,7 +594,8 @@ TEST (unit_saurion, SingleMessageComplete)
   EXPECT_EQ (len, msg_size);
   EXPECT_EQ (strncmp ((char *)dest, message, len), 0);
 
-  list_free (&list);
+  handle_table_destroy (table);
+  request_slab_destroy (slab);
   free (dest);
 }
 
@@ -534,8 +624,11 @@ TEST (unit_saurion, PreviousUnfinishedMessage)
   uint64_t msg_size = strlen (message.get ());
 
   struct request *req = nullptr;
-  struct Node *list = nullptr;
-  int res = set_request (&req, &list, msg_size, message.get (), 1);
+  struct handle_table *table
+      = handle_table_create (SAURION_RING_SIZE, free_request);
+  struct slab *slab = request_slab_create (nullptr, CHUNK_SZ);
+  int res = set_request (&req, slab, table, msg_size, CHUNK_SZ,
+                         message.get (), 1);
   check_request (res, req, 3UL);
   uint64_t size = *(uint64_t *)req->iov[0].iov_base;
   size = ntohll (size);
@@ -551,8 +644,8 @@ TEST (unit_saurion, PreviousUnfinishedMessage)
 
   check_read (len, msg_size, readed, res, req, dest);
 
-  res = set_request (&req, &list, req->prev_remain, message.get () + readed,
-                     0);
+  res = set_request (&req, slab, table, req->prev_remain, CHUNK_SZ,
+                     message.get () + readed, 0);
   EXPECT_EQ (res, SUCCESS_CODE);
 
   req->iovec_count = 1;
@@ -561,8 +654,9 @@ TEST (unit_saurion, PreviousUnfinishedMessage)
   readed = 2 * CHUNK_SZ - sizeof (uint64_t);
   check_read (len, msg_size, readed, res, req, dest);
 
-  res = set_request (&req, &list, req->prev_remain, message.get () + readed,
-                     0);
+  // The last read brings the footer too.
+  res = set_request (&req, slab, table, req->prev_remain + 1, CHUNK_SZ,
+                     message.get () + readed, 0);
   EXPECT_EQ (res, SUCCESS_CODE);
 
   res = read_chunk (&dest, &len, req);
@@ -570,7 +664,8 @@ TEST (unit_saurion, PreviousUnfinishedMessage)
   ASSERT_NE (dest, nullptr);
   EXPECT_EQ (len, msg_size);
 
-  list_free (&list);
+  handle_table_destroy (table);
+  request_slab_destroy (slab);
   free (dest);
 }
 